@@ -0,0 +1,444 @@
+/**
+ * @file Batch.c
+ * @brief .c file containing the lockstep batch simulation engine
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The engine plays BATCH_LANES games side by side, each in a lane of arrays
+ * (struct of arrays): for each seat, the boats and the shots of the board it
+ * targets are two 64-bit words per lane, one bit per case y * n + x, so boards
+ * up to 11x11 fit. A step plays one shot in every lane. The random draws (a
+ * xoshiro256** generator per lane, its state in arrays too) and the resolution
+ * of the shots (hit, hand passing, end of the game) are branch-free loops over
+ * the lanes that the compiler turns into vector instructions, the lanes whose
+ * game is over being masked out until they get the next game of the run. Only
+ * the choice of the case (a swap in a byte array) and the bookkeeping of the
+ * boats sunk by the parity bot stay scalar.
+ *
+ * The random bot shoots the cases of its board in a random order drawn lazily
+ * (one Fisher-Yates swap per shot), which is a uniform draw among the cases not
+ * shot yet, as botTarget: every step plays a shot in every lane, none is drawn
+ * again. The parity bot draws the even cases first and shoots
+ * next to its wrecks as BOT_PARITY does. The n-th game of a run has its fleets
+ * drawn as game n of runSimulation with the same seed.
+ */
+#include "header.h"
+
+#define BATCH_CELLS 128   /**< Cases of the biggest board of the batch engine, two 64-bit words. */
+
+#if defined(__x86_64__) && defined(__GNUC__)
+        #define BATCH_VECTOR __attribute__((target_clones("avx2","default")))   /**< Vector loops also compiled for AVX2 (per-lane shifts), picked when the processor has it. */
+#else
+        #define BATCH_VECTOR
+#endif
+
+/**
+ * @brief Structure representing BATCH_LANES games played in lockstep.
+ */
+typedef struct{
+        uint64_t boats[2][2][BATCH_LANES];            /**< Boats of the board targeted by each seat, per word and per lane. */
+        uint64_t shots[2][2][BATCH_LANES];            /**< Cases of that board already shot. */
+        uint64_t live[2][2][BATCH_LANES];             /**< Wrecks of the boats of that board still afloat, kept for the parity bot. */
+        uint64_t rng[4][BATCH_LANES];                 /**< State of the generator of each lane. */
+        uint64_t draw[BATCH_LANES];                   /**< Random number drawn for each lane by the step, on 32 bits. */
+        uint64_t cell[BATCH_LANES];                   /**< Case shot in each lane by the step. */
+        uint64_t bit[2][BATCH_LANES];                 /**< Case shot in each lane by the step, as a bit of each word. */
+        uint64_t hit[BATCH_LANES];                    /**< 1 if the shot of the lane hit a boat. */
+        uint64_t turn[BATCH_LANES];                   /**< Seat to shoot in each lane. */
+        uint64_t playing[BATCH_LANES];                /**< 1 while the game of the lane goes on. */
+        int64_t winner[BATCH_LANES];                  /**< Winning seat of the game of the lane, -1 while it goes on. */
+        uint64_t nb_shots[2][BATCH_LANES];            /**< Missiles fired by each seat. */
+        int32_t pos[2][BATCH_LANES];                  /**< Cases of the order of each seat already drawn. */
+        uint8_t order[2][BATCH_LANES][BATCH_CELLS];   /**< Cases of each board in the order its seat draws them. */
+        uint8_t boat_at[2][BATCH_LANES][BATCH_CELLS]; /**< Boat on each case of each board. */
+        uint8_t first_order[BATCH_CELLS];             /**< Order of the cases at the start of a game, even cases first for the parity seats. */
+        int* hits_left;                               /**< Intact cases of each boat of each board, [seat][lane][boat]. */
+        Boat* fleets;                                 /**< Fleet of each board, [seat][lane][boat]. */
+        int parity[2];                                /**< 1 if the seat plays the parity bot, 0 for the random bot. */
+        int size;                                     /**< Size of the boards. */
+        int cells;                                    /**< Cases of a board. */
+        int even;                                     /**< Cases of a board where x + y is even. */
+        Bitmask inside;                               /**< Cases of a board. */
+        Bitmask not_first;                            /**< Cases of a board outside its first column. */
+        Bitmask not_last;                             /**< Cases of a board outside its last column. */
+}Batch;
+
+/**
+ * @brief Rotates a 64-bit word to the left.
+ */
+static inline uint64_t batchRotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Draws the next number of the generator of a lane, alone.
+ */
+static uint64_t batchNext(Batch* batch, int lane){
+        uint64_t s0 = batch->rng[0][lane], s1 = batch->rng[1][lane], s2 = batch->rng[2][lane], s3 = batch->rng[3][lane];
+        uint64_t result = batchRotl(s1 * 5,7) * 9;
+        uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = batchRotl(s3,45);
+        batch->rng[0][lane] = s0;
+        batch->rng[1][lane] = s1;
+        batch->rng[2][lane] = s2;
+        batch->rng[3][lane] = s3;
+        return result;
+}
+
+/**
+ * @brief Draws a random number for every lane at once (the xoshiro256** step of batchNext, vectorized over the lanes).
+ */
+BATCH_VECTOR static void batchDraw(Batch* batch){
+        uint64_t* restrict s0 = batch->rng[0];
+        uint64_t* restrict s1 = batch->rng[1];
+        uint64_t* restrict s2 = batch->rng[2];
+        uint64_t* restrict s3 = batch->rng[3];
+        uint64_t* restrict draw = batch->draw;
+        for(int l = 0; l < BATCH_LANES; l++){
+                uint64_t times5 = (s1[l] << 2) + s1[l];         //no 64-bit vector multiply before AVX-512
+                uint64_t rotated = batchRotl(times5,7);
+                uint64_t result = (rotated << 3) + rotated;
+                uint64_t t = s1[l] << 17;
+                s2[l] ^= s0[l];
+                s3[l] ^= s1[l];
+                s1[l] ^= s2[l];
+                s0[l] ^= s3[l];
+                s2[l] ^= t;
+                s3[l] = batchRotl(s3[l],45);
+                draw[l] = result >> 32;
+        }
+}
+
+/**
+ * @brief Turns the case shot in every lane into a bit of each word, at once.
+ */
+BATCH_VECTOR static void batchBits(Batch* batch){
+        uint64_t* restrict cell = batch->cell;
+        uint64_t* restrict low = batch->bit[0];
+        uint64_t* restrict high = batch->bit[1];
+        for(int l = 0; l < BATCH_LANES; l++){
+                uint64_t one = (cell[l] >> 63) + 1;             //1, but GCC only vectorizes the shift of a variable
+                uint64_t bit = one << (cell[l] & 63);
+                uint64_t second = -(cell[l] >> 6);              //all ones for a case of the second word
+                low[l] = bit & ~second;
+                high[l] = bit & second;
+        }
+}
+
+/**
+ * @brief Starts a game of the run in a lane: draws its fleets and clears its boards.
+ *
+ * @param[in,out] batch Pointer to the batch.
+ * @param[in] lane The lane.
+ * @param[in] seed Seed of the game, rngStreamSeed(seed of the run, number of the game).
+ */
+static void batchStart(Batch* batch, int lane, uint64_t seed){
+        int nb = game_config.boat_nb;
+        Boat* fleet[2] = {batch->fleets + (size_t)(0 * BATCH_LANES + lane) * nb, batch->fleets + (size_t)(1 * BATCH_LANES + lane) * nb};
+        Rng rng;
+        rngSeed(&rng,seed);
+        uint64_t start = statsClock();
+        drawBoatList(fleet[1],&rng);                            //the player fleet, shot by seat 1, then the bot fleet, as gameReset
+        drawBoatList(fleet[0],&rng);
+        uint64_t drawn = statsClock();
+        statsThread()->fleet_ns += drawn - start;
+        for(int seat = 0; seat < 2; seat++){
+                Bitmask boats = 0;
+                int* hits_left = batch->hits_left + (size_t)(seat * BATCH_LANES + lane) * nb;
+                for(int b = 0; b < nb; b++){
+                        Boat* boat = &fleet[seat][b];
+                        for(int k = 0; k < boat->boat_size; k++){
+                                int cell = (boat->y_pos + k * boat->orientation) * batch->size + boat->x_pos + k * (1 - boat->orientation);
+                                boats |= (Bitmask)1 << cell;
+                                batch->boat_at[seat][lane][cell] = (uint8_t)b;
+                        }
+                        hits_left[b] = boat->boat_size;
+                }
+                batch->boats[seat][0][lane] = (uint64_t)boats;
+                batch->boats[seat][1][lane] = (uint64_t)(boats >> 64);
+                for(int w = 0; w < 2; w++){
+                        batch->shots[seat][w][lane] = 0;
+                        batch->live[seat][w][lane] = 0;
+                }
+                batch->nb_shots[seat][lane] = 0;
+                batch->pos[seat][lane] = 0;
+                memcpy(batch->order[seat][lane],batch->first_order,batch->cells);
+        }
+        for(int i = 0; i < 4; i++){
+                batch->rng[i][lane] = rng.s[i];
+        }
+        batch->turn[lane] = 0;
+        batch->winner[lane] = -1;
+        batch->playing[lane] = 1;
+        statsThread()->placement_ns += statsClock() - drawn;
+}
+
+/**
+ * @brief Takes the next case of the order of a seat (one Fisher-Yates swap), skipping the cases already shot.
+ *
+ * A parity seat skips the cases it shot next to its wrecks, out of order.
+ *
+ * @param[in,out] batch Pointer to the batch.
+ * @param[in] seat The seat to shoot.
+ * @param[in] lane The lane.
+ * @param[in] draw Random number of the lane.
+ * @return The case.
+ */
+static int batchPick(Batch* batch, int seat, int lane, uint32_t draw){
+        uint8_t* order = batch->order[seat][lane];
+        int pos = batch->pos[seat][lane];
+        while(1){
+                int limit = batch->parity[seat] && pos < batch->even ? batch->even : batch->cells;
+                int j = pos + (int)(((uint64_t)draw * (uint32_t)(limit - pos)) >> 32);
+                uint8_t cell = order[j];
+                order[j] = order[pos];
+                order[pos++] = cell;
+                if(((cell < 64 ? batch->shots[seat][0][lane] >> cell : batch->shots[seat][1][lane] >> (cell - 64)) & 1) == 0){
+                        batch->pos[seat][lane] = pos;
+                        return cell;
+                }
+                draw = (uint32_t)(batchNext(batch,lane) >> 32);  //shot by the parity bot next to a wreck
+        }
+}
+
+/**
+ * @brief Chooses the case shot in every lane with the number drawn by batchDraw.
+ */
+static void batchChoose(Batch* batch){
+        for(int l = 0; l < BATCH_LANES; l++){
+                int seat = (int)batch->turn[l];
+                if(!batch->playing[l]){
+                        continue;
+                }
+                if(!batch->parity[seat]){                       //random: one swap, the cases after pos are never shot
+                        uint8_t* order = batch->order[seat][l];
+                        uint32_t pos = (uint32_t)batch->pos[seat][l];
+                        uint32_t j = pos + (uint32_t)((batch->draw[l] * (batch->cells - pos)) >> 32);
+                        uint8_t cell = order[j];
+                        order[j] = order[pos];
+                        order[pos] = cell;
+                        batch->pos[seat][l] = (int32_t)pos + 1;
+                        batch->cell[l] = cell;
+                        continue;
+                }
+                int cell = -1;
+                if(batch->live[seat][0][l] | batch->live[seat][1][l]){
+                        Bitmask live = ((Bitmask)batch->live[seat][1][l] << 64) | batch->live[seat][0][l];
+                        Bitmask shots = ((Bitmask)batch->shots[seat][1][l] << 64) | batch->shots[seat][0][l];
+                        Bitmask around = ((live << 1) & batch->not_first) | ((live >> 1) & batch->not_last) | (live << batch->size) | (live >> batch->size);
+                        Bitmask targets = around & batch->inside & ~shots;
+                        if(targets != 0){                       //the first case next to a wreck afloat
+                                uint64_t low = (uint64_t)targets;
+                                cell = low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(targets >> 64));
+                        }
+                }
+                if(cell < 0){
+                        cell = batchPick(batch,seat,l,(uint32_t)batch->draw[l]);
+                }
+                batch->cell[l] = (uint64_t)cell;
+        }
+}
+
+/**
+ * @brief Resolves the shot of every lane at once, without a branch: hit, shots, hand passing and end of the game.
+ *
+ * @return 0 if no game ended at this step.
+ */
+BATCH_VECTOR static uint64_t batchResolve(Batch* batch){
+        uint64_t* restrict boats00 = batch->boats[0][0];
+        uint64_t* restrict boats01 = batch->boats[0][1];
+        uint64_t* restrict boats10 = batch->boats[1][0];
+        uint64_t* restrict boats11 = batch->boats[1][1];
+        uint64_t* restrict shots00 = batch->shots[0][0];
+        uint64_t* restrict shots01 = batch->shots[0][1];
+        uint64_t* restrict shots10 = batch->shots[1][0];
+        uint64_t* restrict shots11 = batch->shots[1][1];
+        uint64_t* restrict low = batch->bit[0];
+        uint64_t* restrict high = batch->bit[1];
+        uint64_t* restrict playing = batch->playing;
+        uint64_t* restrict turn = batch->turn;
+        int64_t* restrict winner = batch->winner;
+        uint64_t* restrict hits = batch->hit;
+        uint64_t* restrict nb_shots0 = batch->nb_shots[0];
+        uint64_t* restrict nb_shots1 = batch->nb_shots[1];
+        uint64_t ended = 0;
+        for(int l = 0; l < BATCH_LANES; l++){
+                uint64_t seat1 = -turn[l];
+                uint64_t seat0 = ~seat1;
+                uint64_t active = -playing[l];
+                uint64_t low_bit = low[l] & active;
+                uint64_t high_bit = high[l] & active;
+                uint64_t hit = (seat0 & ((boats00[l] & low_bit) | (boats01[l] & high_bit))) | (seat1 & ((boats10[l] & low_bit) | (boats11[l] & high_bit)));
+                shots00[l] |= low_bit & seat0;
+                shots01[l] |= high_bit & seat0;
+                shots10[l] |= low_bit & seat1;
+                shots11[l] |= high_bit & seat1;
+                uint64_t left0 = (boats00[l] & ~shots00[l]) | (boats01[l] & ~shots01[l]);
+                uint64_t left1 = (boats10[l] & ~shots10[l]) | (boats11[l] & ~shots11[l]);
+                uint64_t is_hit = -((hit | -hit) >> 63);        //all ones if hit isn't 0, without a 64-bit compare (not in SSE2)
+                uint64_t won = is_hit & ((seat0 & (((left0 | -left0) >> 63) - 1)) | (seat1 & (((left1 | -left1) >> 63) - 1)));
+                nb_shots0[l] += active & seat0 & 1;
+                nb_shots1[l] += active & seat1 & 1;
+                hits[l] = is_hit & 1;
+                winner[l] = (int64_t)((won & turn[l]) | (~won & (uint64_t)winner[l]));
+                playing[l] &= ~won;
+                turn[l] ^= active & ~is_hit & 1;                //a miss gives the hand to the other seat
+                ended |= won;
+        }
+        return ended;
+}
+
+/**
+ * @brief Keeps the wrecks of the boats afloat of the parity bots up to date after the hits of the step.
+ */
+static void batchSink(Batch* batch){
+        int nb = game_config.boat_nb;
+        for(int l = 0; l < BATCH_LANES; l++){
+                int seat = (int)batch->turn[l];                 //a hit keeps the hand
+                if(!batch->hit[l] || !batch->parity[seat]){
+                        continue;
+                }
+                int cell = (int)batch->cell[l];
+                int b = batch->boat_at[seat][l][cell];
+                batch->live[seat][cell >> 6][l] |= (uint64_t)1 << (cell & 63);
+                if(--batch->hits_left[(size_t)(seat * BATCH_LANES + l) * nb + b] == 0){
+                        Boat* boat = &batch->fleets[(size_t)(seat * BATCH_LANES + l) * nb + b];
+                        for(int k = 0; k < boat->boat_size; k++){
+                                int c = (boat->y_pos + k * boat->orientation) * batch->size + boat->x_pos + k * (1 - boat->orientation);
+                                batch->live[seat][c >> 6][l] &= ~((uint64_t)1 << (c & 63));
+                        }
+                }
+        }
+}
+
+/**
+ * @brief Runs games with the lockstep batch engine and reports the throughput.
+ *
+ * The games of the run are dealt to the lanes one after the other: as soon as
+ * the game of a lane is over, its result is counted and the lane starts the next
+ * game. The output is the one of runSimulation.
+ *
+ * @param[in] nb_games Number of games to simulate.
+ * @param[in] bot_player Strategy of the player seat, BOT_RANDOM or BOT_PARITY.
+ * @param[in] bot_ennemy Strategy of the bot seat, BOT_RANDOM or BOT_PARITY.
+ * @param[in] seed Seed of the run, game i being played with rngStreamSeed(seed, i).
+ *
+ * @note The function exits with an error message if the number of games is not positive, if a strategy has no batch version, if the boards have more than 128 cases, if the run is logged or if memory allocation fails.
+ */
+void runBatch(long nb_games, Bot_type bot_player, Bot_type bot_ennemy, uint64_t seed){
+        if(nb_games < 1){
+                fprintf(stderr,"Nombre de parties invalide");
+                exit(2);
+        }
+        Bot_type bots[2] = {bot_player, bot_ennemy};
+        for(int seat = 0; seat < 2; seat++){
+                if(bots[seat] != BOT_RANDOM && bots[seat] != BOT_PARITY){
+                        fprintf(stderr,"La stratégie %s n'a pas de version batch (random ou parity)",botTypeName(bots[seat]));
+                        exit(2);
+                }
+        }
+        check_const();
+        int n = game_config.plate_size;
+        if(n * n > BATCH_CELLS){
+                fprintf(stderr,"Le mode batch joue sur des plateaux de %d cases au plus",BATCH_CELLS);
+                exit(2);
+        }
+        if(game_config.log != NULL){
+                fprintf(stderr,"Le mode batch n'écrit pas de journal");
+                exit(2);
+        }
+        int nb = game_config.boat_nb;
+        Batch* batch = aligned_alloc(64,(sizeof(Batch) + 63) & ~(size_t)63);
+        int* hits_left = malloc((size_t)2 * BATCH_LANES * nb * sizeof(int));
+        Boat* fleets = malloc((size_t)2 * BATCH_LANES * nb * sizeof(Boat));
+        if(batch == NULL || hits_left == NULL || fleets == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        memset(batch,0,sizeof(Batch));
+        batch->hits_left = hits_left;
+        batch->fleets = fleets;
+        batch->size = n;
+        batch->cells = n * n;
+        batch->parity[0] = bot_player == BOT_PARITY;
+        batch->parity[1] = bot_ennemy == BOT_PARITY;
+        int k = 0;
+        for(int pass = 0; pass < 2; pass++){                   //the even cases first
+                for(int cell = 0; cell < n * n; cell++){
+                        if((cell % n + cell / n) % 2 == pass){
+                                batch->first_order[k++] = (uint8_t)cell;
+                        }
+                }
+        }
+        batch->even = (n * n + 1) / 2;
+        for(int cell = 0; cell < n * n; cell++){
+                batch->inside |= (Bitmask)1 << cell;
+                batch->not_first |= (Bitmask)(cell % n != 0) << cell;
+                batch->not_last |= (Bitmask)(cell % n != n - 1) << cell;
+        }
+        long game_of[BATCH_LANES];
+        long next = 0;
+        int running = 0;
+        for(int l = 0; l < BATCH_LANES; l++){
+                game_of[l] = -1;
+                if(next < nb_games){
+                        game_of[l] = next;
+                        batchStart(batch,l,rngStreamSeed(seed,next++));
+                        running++;
+                }
+        }
+        long wins[2] = {0, 0};
+        long shots = 0;
+        long win_shots[2] = {0, 0};
+        int parity = batch->parity[0] || batch->parity[1];
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        Stats* stats = statsThread();
+        uint64_t setup_ns = stats->fleet_ns + stats->placement_ns;
+        uint64_t loop_start = statsClock();
+        while(running > 0){
+                batchDraw(batch);
+                batchChoose(batch);
+                batchBits(batch);
+                uint64_t ended = batchResolve(batch);
+                if(parity){
+                        batchSink(batch);
+                }
+                for(int l = 0; ended && l < BATCH_LANES; l++){
+                        if(game_of[l] < 0 || batch->winner[l] < 0){
+                                continue;
+                        }
+                        int winner = (int)batch->winner[l];
+                        int game_shots = (int)(batch->nb_shots[0][l] + batch->nb_shots[1][l]);
+                        wins[winner]++;
+                        shots += game_shots;
+                        win_shots[winner] += (long)batch->nb_shots[winner][l];
+                        statsGame(game_shots);
+                        if(next < nb_games){                    //the lane goes on with the next game of the run
+                                game_of[l] = next;
+                                batchStart(batch,l,rngStreamSeed(seed,next++));
+                        }
+                        else{
+                                game_of[l] = -1;
+                                running--;
+                        }
+                }
+        }
+        stats->play_ns += statsClock() - loop_start - (stats->fleet_ns + stats->placement_ns - setup_ns);   //the games started during the loop aren't play
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        printf("%ld parties simulées par lots de %d en %.3f s (graine %llu)\n",nb_games,BATCH_LANES,elapsed,(unsigned long long)seed);
+        printf("Victoires: joueur %ld (%.2f%%) - bot %ld (%.2f%%)\n",wins[0],100.0 * wins[0] / nb_games,wins[1],100.0 * wins[1] / nb_games);
+        printf("Tirs moyens par partie: %.2f\n",(double)shots / nb_games);
+        printf("Tirs moyens par partie gagnée: joueur %.2f - bot %.2f\n",wins[0] ? (double)win_shots[0] / wins[0] : 0.0,wins[1] ? (double)win_shots[1] / wins[1] : 0.0);
+        printf("Débit: %.0f parties/s\n",nb_games / elapsed);
+        free(hits_left);
+        free(fleets);
+        free(batch);
+}
@@ -0,0 +1,192 @@
+/**
+ * @file Bitboard.c
+ * @brief .c file containing every function relative to bitboards
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * A bitboard stores a whole game board in two 128-bit masks: one bit per case
+ * for the boats and one bit per case for the shots. The case (x,y) is the bit
+ * y * BITBOARD_STRIDE + x, each row keeping an empty guard column on its right.
+ * A wreck is a case set in both masks, so hit tests and win detection are a
+ * few AND and popcount instructions.
+ */
+#include "header.h"
+
+/**
+ * @brief Checks if a board of the given size can be stored in a bitboard.
+ *
+ * @param[in] size Size of the game board.
+ * @return 1 if the board fits in a bitboard, 0 otherwise.
+ */
+int bitBoardFits(int size){
+        return size > 0 && size < BITBOARD_STRIDE;
+}
+
+/**
+ * @brief Counts the number of bits set in a mask.
+ *
+ * @param[in] mask The mask to count.
+ * @return The number of cases set in the mask.
+ */
+int bitPopcount(Bitmask mask){
+        return __builtin_popcountll((unsigned long long)mask) + __builtin_popcountll((unsigned long long)(mask >> 64));
+}
+
+/**
+ * @brief Gives the index of the lowest case set in a mask.
+ *
+ * @param[in] mask The mask to search, must not be empty.
+ * @return The bit index of the first case, y * BITBOARD_STRIDE + x.
+ */
+int bitFirstCell(Bitmask mask){
+        unsigned long long low = (unsigned long long)mask;
+        if(low != 0){
+                return __builtin_ctzll(low);
+        }
+        return 64 + __builtin_ctzll((unsigned long long)(mask >> 64));
+}
+
+/**
+ * @brief Computes the mask of every case of a board.
+ *
+ * @param[in] size Size of the game board, must fit in a bitboard.
+ * @return The mask of the size x size cases, guard columns excluded.
+ */
+Bitmask bitInsideMask(int size){
+        Bitmask inside = 0;
+        for(int i = 0; i < size; i++){
+                inside |= (((Bitmask)1 << size) - 1) << (i * BITBOARD_STRIDE);
+        }
+        return inside;
+}
+
+/**
+ * @brief Grows a mask by one case in the eight directions.
+ *
+ * The column left free at the end of each row keeps the cases of a row from
+ * spilling into the next one.
+ *
+ * @param[in] mask The mask to grow.
+ * @param[in] size Size of the game board.
+ * @return The mask with every case touching one of its cases, inside the board.
+ */
+Bitmask bitGrow(Bitmask mask, int size){
+        mask |= (mask << 1) | (mask >> 1);
+        mask |= (mask << BITBOARD_STRIDE) | (mask >> BITBOARD_STRIDE);
+        return mask & bitInsideMask(size);
+}
+
+/**
+ * @brief Initializes a bitboard with water in all positions.
+ *
+ * Equivalent of gameBoardInit: no boat and no shot.
+ *
+ * @param[out] board Pointer to the bitboard.
+ *
+ * @note The function exits with an error message if the bitboard pointer is NULL.
+ */
+void bitBoardInit(Bit_board* board){
+        if (board == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        board->boats = 0;
+        board->shots = 0;
+}
+
+/**
+ * @brief Computes the mask of the cases covered by a boat.
+ *
+ * @param[in] boat Pointer to the boat.
+ * @return The mask with one bit set per case of the boat.
+ *
+ * @note The function exits with an error message if the boat pointer is NULL.
+ */
+Bitmask boatMask(Boat* boat){
+        if (boat == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Bitmask mask = 0;
+        int step = (boat->orientation == 0) ? 1 : BITBOARD_STRIDE;        //next case on the right or below
+        Bitmask cell = BIT_CELL(boat->x_pos,boat->y_pos);
+        for(int i = 0; i < boat->boat_size; i++){
+                mask |= cell;
+                cell <<= step;
+        }
+        return mask;
+}
+
+/**
+ * @brief Places boats on the bitboard.
+ *
+ * Equivalent of boatPlacement: the cases of every boat are added to the boat mask.
+ *
+ * @param[in,out] board Pointer to the bitboard.
+ * @param[in] boat_list Pointer to the array of boats.
+ *
+ * @note The function exits with an error message if either parameter is NULL.
+ */
+void bitBoatPlacement(Bit_board* board, Boat* boat_list){
+        if (board == NULL || boat_list == NULL){
+                fprintf(stderr,"Erreur de paramètres");
+                exit(2);
+        }
+        for (int i = 0; i < game_config.boat_nb; i++){
+                board->boats |= boatMask(&boat_list[i]);
+        }
+}
+
+/**
+ * @brief Resolves a missile shoot on the bitboard.
+ *
+ * Equivalent of resolveShot: the case is added to the shot mask.
+ *
+ * @param[in,out] board Pointer to the bitboard.
+ * @param[in] x X-coordinate of the targeted case.
+ * @param[in] y Y-coordinate of the targeted case.
+ * @return SHOT_MISS, SHOT_HIT or SHOT_ALREADY.
+ */
+Shot_result bitMissileShoot(Bit_board* board, int x, int y){
+        Bitmask cell = BIT_CELL(x,y);
+        if (board->shots & cell){
+                return SHOT_ALREADY;
+        }
+        board->shots |= cell;
+        return (board->boats & cell) ? SHOT_HIT : SHOT_MISS;
+}
+
+/**
+ * @brief Counts the cases of boats that haven't been hit yet.
+ *
+ * @param[in] board Pointer to the bitboard.
+ * @return The number of intact boat cases, 0 when the whole fleet is destroyed.
+ */
+int bitCellsAlive(Bit_board* board){
+        return bitPopcount(board->boats & ~board->shots);
+}
+
+/**
+ * @brief Counts the number of alive boats on the bitboard.
+ *
+ * Equivalent of howManyAlive: a boat is alive while one of its cases hasn't been shot.
+ *
+ * @param[in] boat_list Pointer to the array of boats.
+ * @param[in] board Pointer to the bitboard.
+ * @return The number of alive boats.
+ *
+ * @note The function exits with an error message if either parameter is NULL.
+ */
+int bitHowManyAlive(Boat* boat_list, Bit_board* board){
+        if(boat_list == NULL || board == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        int compt = 0;
+        for(int i = 0; i < game_config.boat_nb; i++){
+                if (boatMask(&boat_list[i]) & ~board->shots){
+                        compt ++;
+                }
+        }
+        return compt;
+}
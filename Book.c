@@ -0,0 +1,303 @@
+/**
+ * @file Book.c
+ * @brief .c file containing the opening books of the Monte Carlo bot
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * Before the first boat is sunk, the best shot only depends on the board, the
+ * fleet and the cases already shot with their result, so the first shots of
+ * every game can be computed once for all. An opening book is the tree of these
+ * shots: the root is the first shot, and each position has a child for a miss
+ * and a child for a hit. The shot of each position is the case with a boat in
+ * the most layouts agreeing with the board (see countLayouts), which is what
+ * the Monte Carlo bot estimates by sampling.
+ *
+ * The tree is stored as a heap, position i having its children at 2i + 1 (miss)
+ * and 2i + 2 (hit), with one byte per position: the case shot, or BOOK_NONE for
+ * a position left out because too few games reach it (BOOK_MIN_REACH) or no
+ * layout agrees with it. A book of depth d is a header followed by 2^d - 1
+ * bytes, read through mmap with no parsing. A sunk boat leaves the book.
+ */
+#include "header.h"
+
+#define BOOK_MAGIC "BNOB"       /**< First bytes of an opening book. */
+#define BOOK_VERSION 1          /**< Version of the layout of the book. */
+#define BOOK_BYTE_ORDER 0x01020304u   /**< Written in the byte order of the machine. */
+#define BOOK_NONE 255           /**< Shot of a position outside of the book. */
+#define BOOK_MAX_DEPTH 24       /**< Deepest book, 16 MiB on disk. */
+
+/**
+ * @brief Structure representing the header of an opening book file.
+ */
+typedef struct{
+        char magic[4];        /**< BOOK_MAGIC. */
+        uint32_t version;     /**< BOOK_VERSION. */
+        uint32_t byte_order;  /**< BOOK_BYTE_ORDER. */
+        uint32_t plate_size;  /**< Size of the game boards. */
+        uint32_t boat_nb;     /**< Number of boats of each fleet. */
+        uint32_t fleet_hash;  /**< Hash of the sizes of the boats of the fleet and of the margin. */
+        uint32_t depth;       /**< Number of shots covered by the book. */
+        uint32_t reserved;    /**< Zero. */
+}Book_header;
+
+/**
+ * @brief Structure representing a book being built.
+ */
+typedef struct{
+        Game_board* board;    /**< Board of the position being computed, with WATER on the cases not shot. */
+        Boat* boats;          /**< Fleet of the board, none of them sunk. */
+        double* probabilities;/**< Share of the layouts with a boat on each case, for each level of the tree. */
+        uint8_t* shots;       /**< The tree. */
+        int depth;            /**< Number of shots covered by the book. */
+        long nb_positions;    /**< Positions computed so far. */
+}Book_builder;
+
+/**
+ * @brief Builds the header matching the current configuration.
+ *
+ * @param[out] header The header.
+ * @param[in] depth Number of shots covered by the book.
+ */
+static void bookHeader(Book_header* header, int depth){
+        memset(header,0,sizeof(*header));
+        memcpy(header->magic,BOOK_MAGIC,4);
+        header->version = BOOK_VERSION;
+        header->byte_order = BOOK_BYTE_ORDER;
+        header->plate_size = game_config.plate_size;
+        header->boat_nb = game_config.boat_nb;
+        uint32_t hash = 2166136261u;                            //FNV-1a of the boat sizes, as in the move log
+        for(int i = 0; i < game_config.boat_nb; i++){
+                hash = (hash ^ (uint32_t)game_config.boat_sizes[i]) * 16777619u;
+        }
+        if(game_config.margin > 0){
+                hash = (hash ^ (0x80000000u | (uint32_t)game_config.margin)) * 16777619u;
+        }
+        header->fleet_hash = hash;
+        header->depth = depth;
+}
+
+/**
+ * @brief Computes the shot of a position of the tree, then the positions following a miss and a hit.
+ *
+ * @param[in,out] builder The book being built, whose board holds the position.
+ * @param[in] node Index of the position in the tree.
+ * @param[in] level Number of shots on the board.
+ * @param[in] reach Share of the games reaching the position.
+ */
+static void bookExpand(Book_builder* builder, int node, int level, double reach){
+        if(level == builder->depth || reach < BOOK_MIN_REACH){
+                return;
+        }
+        Game_board* board = builder->board;
+        int nb_cells = board->Matrix_size * board->Matrix_size;
+        double* probabilities = builder->probabilities + (size_t)level * nb_cells;
+        if(countLayouts(board,builder->boats,probabilities,0) == 0){
+                return;
+        }
+        int best = -1;
+        for(int i = 0; i < nb_cells; i++){                      //first case among the most probable ones, as the other bots
+                Case_type type = board->cells[i];
+                if(type != WATER_SHOT && type != WRECK && (best < 0 || probabilities[i] > probabilities[best])){
+                        best = i;
+                }
+        }
+        if(best < 0){
+                return;
+        }
+        double hit = probabilities[best];
+        builder->shots[node] = best;
+        builder->nb_positions++;
+        fprintf(stderr,"\rLivre: %ld positions, profondeur %d",builder->nb_positions,level + 1);
+        board->cells[best] = WATER_SHOT;
+        bookExpand(builder,2 * node + 1,level + 1,reach * (1 - hit));
+        board->cells[best] = WRECK;
+        bookExpand(builder,2 * node + 2,level + 1,reach * hit);
+        board->cells[best] = WATER;
+}
+
+/**
+ * @brief Computes the opening book of the current board and fleet and writes it to a file.
+ *
+ * Every position reached by at least BOOK_MIN_REACH of the games, counting the
+ * layouts of the fleet as equally likely, is computed with countLayouts; the
+ * book is written with a single write once the tree is done. The first
+ * positions take the longest, the empty board having the most layouts.
+ *
+ * @param[in] path Path of the book.
+ * @param[in] depth Number of shots covered by the book, from 1 to BOOK_MAX_DEPTH.
+ *
+ * @note The function exits with an error message if a parameter is invalid, if the board has more than 255 cases,
+ * if counting is impossible (see countLayouts), if the file can't be written or if memory allocation fails.
+ */
+void runBook(const char* path, int depth){
+        if(path == NULL || depth < 1 || depth > BOOK_MAX_DEPTH){
+                fprintf(stderr,"Paramètres invalides (profondeur de 1 à %d)",BOOK_MAX_DEPTH);
+                exit(2);
+        }
+        check_const();
+        int n = game_config.plate_size;
+        if(n * n >= BOOK_NONE){
+                fprintf(stderr,"Un livre d'ouverture couvre des plateaux de %d cases au plus",BOOK_NONE - 1);
+                exit(2);
+        }
+        size_t nb_nodes = ((size_t)1 << depth) - 1;
+        size_t length = sizeof(Book_header) + nb_nodes;
+        char* buffer = malloc(length);
+        Book_builder builder;
+        builder.board = createGameBoard(n);
+        builder.boats = calloc(game_config.boat_nb,sizeof(Boat));
+        builder.probabilities = malloc((size_t)depth * n * n * sizeof(double));
+        if(buffer == NULL || builder.boats == NULL || builder.probabilities == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        gameBoardInit(builder.board);
+        for(int i = 0; i < game_config.boat_nb; i++){           //no boat sunk inside the book
+                builder.board->hits_left[i] = game_config.boat_sizes[i];
+        }
+        bookHeader((Book_header*)buffer,depth);
+        builder.shots = (uint8_t*)buffer + sizeof(Book_header);
+        memset(builder.shots,BOOK_NONE,nb_nodes);
+        builder.depth = depth;
+        builder.nb_positions = 0;
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        bookExpand(&builder,0,0,1.0);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        fprintf(stderr,"\n");
+
+        int fd = open(path,O_WRONLY | O_CREAT | O_TRUNC,0644);
+        if(fd < 0){
+                fprintf(stderr,"Impossible d'ouvrir %s",path);
+                exit(5);
+        }
+        for(size_t done = 0; done < length; ){
+                ssize_t written = write(fd,buffer + done,length - done);
+                if(written <= 0){
+                        fprintf(stderr,"Erreur d'écriture dans %s",path);
+                        exit(5);
+                }
+                done += written;
+        }
+        close(fd);
+        printf("Livre d'ouverture de %d tirs: %ld positions calculées en %.3f s, %zu octets écrits dans %s\n",depth,builder.nb_positions,
+               (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9,length,path);
+        if(builder.shots[0] != BOOK_NONE){
+                printf("Premier tir: (%d,%d)\n",builder.shots[0] % n,builder.shots[0] / n);
+        }
+        free(builder.probabilities);
+        free(builder.boats);
+        freeGameBoard(builder.board);
+        free(buffer);
+}
+
+/**
+ * @brief Maps an opening book written by runBook.
+ *
+ * @param[in] path Path of the book.
+ * @return The book, to be closed with bookClose.
+ *
+ * @note The function exits with an error message if the file can't be read, isn't a book, or was computed for another
+ * board or fleet, or if memory allocation fails.
+ */
+Opening_book* bookOpen(const char* path){
+        int fd = open(path,O_RDONLY);
+        struct stat info;
+        if(fd < 0 || fstat(fd,&info) != 0){
+                fprintf(stderr,"Impossible d'ouvrir %s",path);
+                exit(5);
+        }
+        if((size_t)info.st_size < sizeof(Book_header)){
+                fprintf(stderr,"Ce fichier n'est pas un livre d'ouverture");
+                exit(5);
+        }
+        const char* data = mmap(NULL,info.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+        close(fd);
+        if(data == MAP_FAILED){
+                fprintf(stderr,"Impossible de lire %s",path);
+                exit(5);
+        }
+        const Book_header* header = (const Book_header*)data;
+        if(memcmp(header->magic,BOOK_MAGIC,4) != 0 || header->byte_order != BOOK_BYTE_ORDER){
+                fprintf(stderr,"Ce fichier n'est pas un livre d'ouverture");
+                exit(5);
+        }
+        if(header->version != BOOK_VERSION){
+                fprintf(stderr,"Version de livre non supportée: %u",header->version);
+                exit(5);
+        }
+        Book_header expected;
+        bookHeader(&expected,header->depth);
+        if(memcmp(header,&expected,sizeof(expected)) != 0){
+                fprintf(stderr,"Le livre a été calculé pour un autre plateau ou une autre flotte");
+                exit(5);
+        }
+        if(header->depth < 1 || header->depth > BOOK_MAX_DEPTH || (size_t)info.st_size != sizeof(Book_header) + ((size_t)1 << header->depth) - 1){
+                fprintf(stderr,"Livre d'ouverture tronqué: %s",path);
+                exit(5);
+        }
+        Opening_book* book = malloc(sizeof(Opening_book));
+        if(book == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        book->map = data;
+        book->map_size = info.st_size;
+        book->shots = (const uint8_t*)(data + sizeof(Book_header));
+        book->depth = header->depth;
+        return book;
+}
+
+/**
+ * @brief Unmaps an opening book.
+ *
+ * @param[in] book The book, may be NULL.
+ */
+void bookClose(Opening_book* book){
+        if(book == NULL){
+                return;
+        }
+        munmap((void*)book->map,book->map_size);
+        free(book);
+}
+
+/**
+ * @brief Gives the case to shoot in a position of the book.
+ *
+ * The position must hold as many shots as the board: a game resumed from a
+ * checkpoint, whose shots the book didn't follow, never uses it.
+ *
+ * @param[in] book The book, may be NULL.
+ * @param[in] board The targeted board.
+ * @param[in] node Index of the position in the tree, negative outside of the book.
+ * @return The case to shoot (y * size + x), -1 if the position is outside of the book.
+ */
+int bookShot(const Opening_book* book, const Game_board* board, int node){
+        if(book == NULL || node < 0 || (size_t)node >= ((size_t)1 << book->depth) - 1){
+                return -1;
+        }
+        int nb_cells = board->Matrix_size * board->Matrix_size;
+        int level = 31 - __builtin_clz((unsigned)node + 1);
+        int cell = book->shots[node];
+        if(level != nb_cells - board->nb_unshot || cell >= nb_cells || board->cells[cell] == WATER_SHOT || board->cells[cell] == WRECK){
+                return -1;
+        }
+        return cell;
+}
+
+/**
+ * @brief Gives the position following a shot of the book.
+ *
+ * @param[in] book The book, may be NULL.
+ * @param[in] node Index of the position in the tree, negative outside of the book.
+ * @param[in] result Result of the shot of the position.
+ * @return The following position, -1 once a boat is sunk or past the depth of the book.
+ */
+int bookFollow(const Opening_book* book, int node, Shot_result result){
+        if(book == NULL || node < 0 || (result != SHOT_MISS && result != SHOT_HIT)){
+                return -1;
+        }
+        size_t next = 2 * (size_t)node + (result == SHOT_MISS ? 1 : 2);
+        return (next < ((size_t)1 << book->depth) - 1) ? (int)next : -1;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file Config.c
+ * @brief .c file containing the runtime configuration of the game
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The size of the board and the composition of the fleet are chosen when the
+ * program starts, PLATE_SIZE and BOAT_NB only giving their default values. The
+ * configuration is written once by configInit, before any game or thread is
+ * created, and only read afterwards; the modes playing games on several threads
+ * only set mc_threads before starting them.
+ */
+#include "header.h"
+
+Game_config game_config = {PLATE_SIZE, 0, NULL, 0, 0, 0, 0, NULL, NULL, 0};            /**< Configuration shared by every game of the run. */
+
+/**
+ * @brief Reads the list of boat sizes of a --fleet option.
+ *
+ * @param[in] list Comma separated sizes, for instance "5,4,3,3,2".
+ *
+ * @note The function exits with an error message if the list is invalid or if memory allocation fails.
+ */
+static void configFleet(const char* list){
+        int nb = 1;
+        for(const char* c = list; *c != '\0'; c++){
+                nb += (*c == ',');
+        }
+        free(game_config.boat_sizes);
+        game_config.boat_sizes = malloc(nb * sizeof(int));
+        if(game_config.boat_sizes == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        char* end;
+        for(int i = 0; i < nb; i++){
+                game_config.boat_sizes[i] = (int)strtol(list,&end,10);
+                if(end == list || game_config.boat_sizes[i] < 1){
+                        fprintf(stderr,"Flotte invalide: %s",list);
+                        exit(4);
+                }
+                list = (*end == ',') ? end + 1 : end;
+        }
+        game_config.boat_nb = nb;
+}
+
+/**
+ * @brief Closes the move log and the opening book when the program ends.
+ */
+static void configClose(){
+        moveLogClose(game_config.log);
+        game_config.log = NULL;
+        bookClose(game_config.book);
+        game_config.book = NULL;
+}
+
+/**
+ * @brief Initializes the configuration from the command line.
+ *
+ * The options --size <size>, --fleet <size,size,...>, --margin <cases>, --seed <seed>,
+ * --log <file>, --stats <file>, --book <file> and --ansi can be given anywhere on the command line; they are removed from argv so the rest of
+ * the arguments can be read as before. Without --fleet, the fleet has BOAT_NB
+ * boats, boat i having size i + 1. With --margin, the boats of a fleet are kept
+ * that many cases apart, not even touching by a corner. Without --seed, the seed is the current time.
+ * With --log, every game and shot of the run is appended to the move log, which
+ * is closed when the program ends. With --stats, the counters of the hot paths
+ * are written when the program ends (see Stats.c). With --book, the opening book
+ * is mapped for the Monte Carlo bot, once the fleet is known (see Book.c).
+ *
+ * @param[in,out] argc Pointer to the number of arguments.
+ * @param[in,out] argv Array of the arguments.
+ *
+ * @note The function exits with an error message if an option has no value or if memory allocation fails.
+ */
+void configInit(int* argc, char** argv){
+        game_config.seed = (uint64_t)time(NULL);
+        const char* log_path = NULL;
+        const char* book_path = NULL;
+        int kept = 1;
+        for(int i = 1; i < *argc; i++){
+                if(strcmp(argv[i],"--ansi") == 0){              //the only option without a value
+                        game_config.ansi = 1;
+                        continue;
+                }
+                int is_option = strcmp(argv[i],"--size") == 0 || strcmp(argv[i],"--fleet") == 0 || strcmp(argv[i],"--seed") == 0 || strcmp(argv[i],"--log") == 0 || strcmp(argv[i],"--stats") == 0 || strcmp(argv[i],"--margin") == 0 || strcmp(argv[i],"--book") == 0;
+                if(!is_option){
+                        argv[kept++] = argv[i];
+                        continue;
+                }
+                if(i + 1 >= *argc){
+                        fprintf(stderr,"Valeur manquante pour %s",argv[i]);
+                        exit(4);
+                }
+                if(strcmp(argv[i],"--size") == 0){
+                        game_config.plate_size = atoi(argv[i + 1]);
+                }
+                else if(strcmp(argv[i],"--fleet") == 0){
+                        configFleet(argv[i + 1]);
+                }
+                else if(strcmp(argv[i],"--log") == 0){
+                        log_path = argv[i + 1];
+                }
+                else if(strcmp(argv[i],"--book") == 0){
+                        book_path = argv[i + 1];
+                }
+                else if(strcmp(argv[i],"--stats") == 0){
+                        statsOpen(argv[i + 1]);
+                }
+                else if(strcmp(argv[i],"--margin") == 0){
+                        game_config.margin = atoi(argv[i + 1]);
+                        if(game_config.margin < 0){
+                                fprintf(stderr,"Marge invalide: %s",argv[i + 1]);
+                                exit(4);
+                        }
+                }
+                else{
+                        game_config.seed = strtoull(argv[i + 1],NULL,10);
+                }
+                i++;
+        }
+        *argc = kept;
+        if(game_config.boat_sizes == NULL){                    //default fleet: boat i of size i + 1
+                game_config.boat_nb = BOAT_NB;
+                game_config.boat_sizes = malloc(BOAT_NB * sizeof(int));
+                if(game_config.boat_sizes == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                for(int i = 0; i < BOAT_NB; i++){
+                        game_config.boat_sizes[i] = i + 1;
+                }
+        }
+        game_config.max_boat_size = 0;
+        for(int i = 0; i < game_config.boat_nb; i++){
+                if(game_config.boat_sizes[i] > game_config.max_boat_size){
+                        game_config.max_boat_size = game_config.boat_sizes[i];
+                }
+        }
+        if(log_path != NULL){                                   //the header of the log records the fleet
+                game_config.log = moveLogOpen(log_path);
+        }
+        if(book_path != NULL){                                  //so does the header of the book
+                game_config.book = bookOpen(book_path);
+        }
+        if(log_path != NULL || book_path != NULL){
+                atexit(configClose);
+        }
+}
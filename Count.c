@@ -0,0 +1,665 @@
+/**
+ * @file Count.c
+ * @brief .c file containing the exact counting of the fleet layouts
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The engine counts every layout of the fleet that agrees with what the shooter
+ * knows of a board: no boat on a miss nor on a sunk boat, every wreck of a boat
+ * still alive covered, and no remaining boat lying on wrecks only, since it
+ * would be sunk. Boats of the same size are interchangeable: two layouts only
+ * differing by the swap of two boats of the same size are the same layout.
+ *
+ * The cases are visited row after row (broken profile dynamic programming). The
+ * state before a case holds, for each column, how many more cases of the column
+ * are covered by a vertical boat already placed, how many more cases of the row
+ * are covered by the horizontal boat already placed, and how many boats of each
+ * size are still to place. A case is either covered by one of these boats, or
+ * left empty, or the first case of a new boat. Every state is packed in 128 bits
+ * and the layouts leading to it are summed in a hash table, one per case, so
+ * the layouts sharing a state are never enumerated one by one.
+ *
+ * When the probabilities are asked, the tables of the first case of every row
+ * are kept; a backward pass then replays each row from its table and gives for
+ * each state the number of ways to complete it. The product of both counts,
+ * summed over the steps putting a boat on a case, is the number of layouts with
+ * a boat on that case.
+ */
+#include "header.h"
+
+typedef unsigned __int128 Count_key;     /**< State of the dynamic programming, packed. */
+typedef unsigned __int128 Count_value;   /**< Number of layouts. */
+
+#define COUNT_MAX_STEPS (2 * 64 + 1)     /**< Most steps out of a state: empty case, or a boat of each size in both orientations. */
+#define COUNT_BATCH 16                   /**< States whose steps are listed before they are added, so the slots they go to are fetched meanwhile. */
+
+/**
+ * @brief Structure representing a state with its number of layouts.
+ */
+typedef struct{
+        Count_key key;        /**< Packed state. */
+        Count_value count;    /**< Layouts of the cases before, leading to the state. */
+}Count_entry;
+
+/**
+ * @brief Structure representing the states reached before a case.
+ */
+typedef struct{
+        Count_entry* entries; /**< The states, in the order they were reached. */
+        uint64_t* slots;      /**< Hash table of the states, open addressing: high bits of the hash of the state, then 1 + its index; 0 for an empty slot. */
+        Count_value* after;   /**< Ways to complete each state with the next cases, filled by the backward pass. */
+        size_t capacity;      /**< Number of slots, a power of two. */
+        size_t nb;            /**< Number of states. */
+        size_t room;          /**< Number of states allocated. */
+}Count_layer;
+
+/**
+ * @brief Structure representing what is counted: the board, the observation and the packing of the states.
+ */
+typedef struct{
+        int size;             /**< Size of the game board. */
+        const char* blocked;  /**< 1 on the cases no remaining boat can cover: misses and sunk boats. */
+        const char* hit;      /**< 1 on the wrecks of boats not sunk yet. */
+        char* fits;           /**< Per kind, orientation and first case, 1 if a boat stays on the board, on free cases and not on wrecks only. */
+        int nb_kinds;         /**< Number of different sizes among the remaining boats. */
+        int kind_size[64];    /**< Size of the boats of each kind. */
+        int kind_shift[64];   /**< Position of the number of boats of each kind in a state. */
+        int kind_bits[64];    /**< Bits of the number of boats of each kind in a state. */
+        int bits;             /**< Bits of a column, and of the horizontal boat, in a state. */
+}Count_context;
+
+/**
+ * @brief Structure representing what can happen on a case, the masks of its steps computed once for all the states.
+ */
+typedef struct{
+        Count_key covering;   /**< Fields of the column of the case and of the horizontal boat: the case is covered if one isn't 0. */
+        Count_key column_field; /**< Field of the column of the case. */
+        Count_key column_one; /**< One case covered by a vertical boat in the column of the case. */
+        Count_key row_one;    /**< One case covered by the horizontal boat. */
+        int blocked;          /**< 1 if no boat can cover the case. */
+        int hit;              /**< 1 if a boat must cover the case. */
+        int nb_boats;         /**< Number of boats, by kind and orientation, that fit on the board from the case. */
+        Count_key boat_left[2 * 64];   /**< Field of the boats left of the kind of each boat, which mustn't be 0. */
+        Count_key boat_span[2 * 64];   /**< Columns of each boat, which must be free of vertical boats. */
+        Count_key boat_change[2 * 64]; /**< What each boat adds to the state: a boat less of its kind, its next cases covered. */
+}Count_moves;
+
+/**
+ * @brief Gives the number of bits needed to write a value.
+ *
+ * @param[in] value A non negative value.
+ * @return The number of bits, at least 1.
+ */
+static int countBits(int value){
+        int bits = 1;
+        while((value >> bits) != 0){
+                bits++;
+        }
+        return bits;
+}
+
+/**
+ * @brief Allocates an empty layer.
+ *
+ * @param[out] layer The layer.
+ * @param[in] capacity Number of slots, a power of two.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+static void countLayerInit(Count_layer* layer, size_t capacity){
+        layer->slots = calloc(capacity,sizeof(uint64_t));
+        layer->entries = malloc(capacity / 2 * sizeof(Count_entry));
+        layer->after = NULL;
+        layer->capacity = capacity;
+        layer->nb = 0;
+        layer->room = capacity / 2;
+        if(layer->slots == NULL || layer->entries == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+}
+
+/**
+ * @brief Empties a layer, keeping its memory for the next case.
+ *
+ * @param[in,out] layer The layer.
+ */
+static void countLayerClear(Count_layer* layer){
+        memset(layer->slots,0,layer->capacity * sizeof(uint64_t));
+        layer->nb = 0;
+}
+
+/**
+ * @brief Frees a layer.
+ *
+ * @param[in,out] layer The layer.
+ */
+static void countLayerFree(Count_layer* layer){
+        free(layer->entries);
+        free(layer->slots);
+        free(layer->after);
+        layer->entries = NULL;
+        layer->slots = NULL;
+        layer->after = NULL;
+}
+
+/**
+ * @brief Hashes a state.
+ *
+ * The low bits give the first slot where the state is looked for, the high 32
+ * bits are kept in its slot so most slots of other states are passed without
+ * reading their state.
+ *
+ * @param[in] key The packed state.
+ * @return The hash.
+ */
+static inline uint64_t countHash(Count_key key){
+        uint64_t hash = (uint64_t)key ^ (uint64_t)(key >> 64) * 0x9E3779B97F4A7C15ull;
+        hash = (hash ^ (hash >> 31)) * 0xBF58476D1CE4E5B9ull;                     //mixed so every bit of the state moves the slot
+        return hash ^ (hash >> 29);
+}
+
+/**
+ * @brief Gives the slot of a state in a layer: the slot holding it, or the empty slot where it goes.
+ *
+ * @param[in] layer The layer.
+ * @param[in] key The packed state.
+ * @param[in] hash countHash(key).
+ * @return The index of the slot.
+ */
+static inline size_t countSlot(const Count_layer* layer, Count_key key, uint64_t hash){
+        size_t slot = hash & (layer->capacity - 1);
+        uint64_t tag = hash >> 32;
+        while(layer->slots[slot] != 0 && ((layer->slots[slot] >> 32) != tag || layer->entries[(uint32_t)layer->slots[slot] - 1].key != key)){   //linear probing
+                slot = (slot + 1) & (layer->capacity - 1);
+        }
+        return slot;
+}
+
+/**
+ * @brief Gives the index of a state in a layer.
+ *
+ * @param[in] layer The layer.
+ * @param[in] key The packed state.
+ * @return The index of the state, -1 if the layer doesn't have it.
+ */
+static inline long countFind(const Count_layer* layer, Count_key key){
+        return (long)(uint32_t)layer->slots[countSlot(layer,key,countHash(key))] - 1;
+}
+
+/**
+ * @brief Adds layouts to a state of a layer, the hash table doubling when half full.
+ *
+ * @param[in,out] layer The layer.
+ * @param[in] key The packed state.
+ * @param[in] count Number of layouts leading to the state.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+static void countLayerAdd(Count_layer* layer, Count_key key, Count_value count){
+        uint64_t hash = countHash(key);
+        size_t slot = countSlot(layer,key,hash);
+        if(layer->slots[slot] != 0){
+                layer->entries[(uint32_t)layer->slots[slot] - 1].count += count;
+                return;
+        }
+        if(layer->nb == layer->room){
+                layer->room *= 2;
+                layer->entries = realloc(layer->entries,layer->room * sizeof(Count_entry));
+                if(layer->entries == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+        }
+        layer->entries[layer->nb].key = key;
+        layer->entries[layer->nb].count = count;
+        layer->slots[slot] = (hash >> 32 << 32) | ++layer->nb;
+        if(2 * layer->nb > layer->capacity){
+                free(layer->slots);
+                layer->capacity *= 2;
+                layer->slots = calloc(layer->capacity,sizeof(uint64_t));
+                if(layer->slots == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                for(size_t i = 0; i < layer->nb; i++){
+                        uint64_t rehash = countHash(layer->entries[i].key);
+                        layer->slots[countSlot(layer,layer->entries[i].key,rehash)] = (rehash >> 32 << 32) | (i + 1);
+                }
+        }
+}
+
+/**
+ * @brief Lists what can happen on a case, from the board alone.
+ *
+ * @param[in] context What is counted.
+ * @param[in] cell Index of the case, row after row.
+ * @param[out] moves The masks of the case and the boats that fit on the board from it.
+ */
+static void countMoves(const Count_context* context, int cell, Count_moves* moves){
+        int n = context->size;
+        int bits = context->bits;
+        int x = cell % n;
+        size_t nb_cells = (size_t)n * n;
+        Count_key field = ((Count_key)1 << bits) - 1;
+        moves->column_one = (Count_key)1 << (x * bits);
+        moves->row_one = (Count_key)1 << (n * bits);
+        moves->column_field = field * moves->column_one;
+        moves->covering = moves->column_field | field * moves->row_one;
+        moves->blocked = context->blocked[cell];
+        moves->hit = context->hit[cell];
+        moves->nb_boats = 0;
+        for(int k = 0; k < context->nb_kinds && !moves->blocked; k++){
+                int size = context->kind_size[k];
+                Count_key kind_one = (Count_key)1 << context->kind_shift[k];
+                Count_key kind_field = (((Count_key)1 << context->kind_bits[k]) - 1) * kind_one;
+                const char* fits = context->fits + 2 * k * nb_cells;
+                if(fits[cell]){                                  //horizontal, its columns free of vertical boats
+                        moves->boat_left[moves->nb_boats] = kind_field;
+                        moves->boat_span[moves->nb_boats] = (((Count_key)1 << (size * bits)) - 1) * moves->column_one;
+                        moves->boat_change[moves->nb_boats++] = (Count_key)(size - 1) * moves->row_one - kind_one;
+                }
+                if(size > 1 && fits[nb_cells + cell]){           //vertical, a boat of size 1 counted once
+                        moves->boat_left[moves->nb_boats] = kind_field;
+                        moves->boat_span[moves->nb_boats] = 0;
+                        moves->boat_change[moves->nb_boats++] = (Count_key)(size - 1) * moves->column_one - kind_one;
+                }
+        }
+}
+
+/**
+ * @brief Lists the states following a state once a case is decided.
+ *
+ * Below a vertical boat or right of a horizontal one, the case is covered; else
+ * it is left empty, which a wreck forbids, or a boat of a remaining size starts
+ * on it, horizontal or vertical. The state is changed in its packed form: a
+ * field is decremented or set by adding to the key.
+ *
+ * @param[in] moves What can happen on the case.
+ * @param[in] key The packed state before the case.
+ * @param[out] next The packed states after the case.
+ * @param[out] covered For each next state, 1 if a boat is on the case.
+ * @return The number of next states.
+ */
+static inline int countSteps(const Count_moves* moves, Count_key key, Count_key* next, int* covered){
+        if((key & moves->covering) != 0){                        //already covered by a boat
+                if(moves->blocked){
+                        return 0;
+                }
+                next[0] = key - (((key & moves->column_field) != 0) ? moves->column_one : moves->row_one);
+                covered[0] = 1;
+                return 1;
+        }
+        int nb = 0;
+        if(!moves->hit){                                         //left empty
+                next[nb] = key;
+                covered[nb++] = 0;
+        }
+        for(int b = 0; b < moves->nb_boats; b++){                //a new boat starts here
+                if((key & moves->boat_left[b]) != 0 && (key & moves->boat_span[b]) == 0){
+                        next[nb] = key + moves->boat_change[b];
+                        covered[nb++] = 1;
+                }
+        }
+        return nb;
+}
+
+/**
+ * @brief Decides the case of a layer for each of its states, summing the layouts of the states reached in the next layer.
+ *
+ * @param[in] context What is counted.
+ * @param[in] cell Index of the case.
+ * @param[in] layer The states before the case.
+ * @param[out] following The states after the case, a layer initialized empty.
+ */
+static void countForward(const Count_context* context, int cell, const Count_layer* layer, Count_layer* following){
+        Count_key next[COUNT_BATCH * COUNT_MAX_STEPS];
+        Count_value counts[COUNT_BATCH * COUNT_MAX_STEPS];
+        int covered[COUNT_MAX_STEPS];
+        Count_moves moves;
+        countMoves(context,cell,&moves);
+        for(size_t i = 0; i < layer->nb; i += COUNT_BATCH){
+                int nb = 0;
+                for(size_t j = i; j < i + COUNT_BATCH && j < layer->nb; j++){      //steps of a few states, whose slots are fetched meanwhile
+                        const Count_entry* entry = &layer->entries[j];
+                        int steps = countSteps(&moves,entry->key,next + nb,covered);
+                        for(int s = 0; s < steps; s++){
+                                __builtin_prefetch(&following->slots[countHash(next[nb]) & (following->capacity - 1)]);
+                                counts[nb++] = entry->count;
+                        }
+                }
+                for(int s = 0; s < nb; s++){
+                        countLayerAdd(following,next[s],counts[s]);
+                }
+        }
+}
+
+/**
+ * @brief Gives the ways to complete each state of a layer from those of the next layer, and the layouts with a boat on the case.
+ *
+ * @param[in] context What is counted.
+ * @param[in] cell Index of the case.
+ * @param[in,out] layer The states before the case, whose after array is allocated and filled.
+ * @param[in] following The states after the case, with their after array filled.
+ * @return The number of layouts with a boat on the case.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+static long double countBackward(const Count_context* context, int cell, Count_layer* layer, const Count_layer* following){
+        Count_key next[COUNT_MAX_STEPS];
+        int covered[COUNT_MAX_STEPS];
+        free(layer->after);
+        layer->after = calloc(layer->nb + 1,sizeof(Count_value));
+        if(layer->after == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        Count_moves moves;
+        countMoves(context,cell,&moves);
+        long double with_boat = 0;
+        for(size_t i = 0; i < layer->nb; i++){
+                const Count_entry* entry = &layer->entries[i];
+                int nb = countSteps(&moves,entry->key,next,covered);
+                for(int s = 0; s < nb; s++){
+                        Count_value ways = following->after[countFind(following,next[s])];
+                        layer->after[i] += ways;
+                        if(covered[s]){
+                                with_boat += (long double)entry->count * ways;
+                        }
+                }
+        }
+        return with_boat;
+}
+
+/**
+ * @brief Writes a number of layouts in decimal.
+ *
+ * @param[in] value The number.
+ * @param[out] out Buffer of at least 40 characters.
+ * @return out.
+ */
+char* countFormat(unsigned __int128 value, char* out){
+        char digits[40];
+        int nb = 0;
+        do{
+                digits[nb++] = '0' + (int)(value % 10);
+                value /= 10;
+        }while(value != 0);
+        for(int i = 0; i < nb; i++){
+                out[i] = digits[nb - 1 - i];
+        }
+        out[nb] = '\0';
+        return out;
+}
+
+/**
+ * @brief Counts the layouts of the remaining boats that agree with what the shooter knows of a board.
+ *
+ * With a NULL board, every layout of the fleet of the configuration on an empty
+ * board is counted. Otherwise the misses and the wrecks of the board are read, and
+ * the boats already sunk, whose place the shooter knows, are taken out of the fleet
+ * with their cases.
+ *
+ * @param[in] board Pointer to the observed game board, or NULL for an empty board of the configured size.
+ * @param[in] boat_list Pointer to the array of the boats of the board, NULL with a NULL board.
+ * @param[out] probabilities For each case, share of the layouts with a boat on it; NULL to only count, about four times faster
+ * and keeps two tables instead of one per row.
+ * @param[in] progress 1 to display the progress on the error output, row after row.
+ * @return The number of layouts, 0 if none agrees with the board.
+ *
+ * @note The function exits with an error message if the board is wider than DENSITY_MAX_SIZE, if a state doesn't
+ * fit in 128 bits, if boats must be kept apart (--margin) or if memory allocation fails.
+ */
+unsigned __int128 countLayouts(Game_board* board, Boat* boat_list, double* probabilities, int progress){
+        int n = (board != NULL) ? board->Matrix_size : game_config.plate_size;
+        size_t nb_cells = (size_t)n * n;
+        if(n > DENSITY_MAX_SIZE || game_config.margin > 0 || (board != NULL && boat_list == NULL)){
+                fprintf(stderr,"Comptage exact impossible: plateau de plus de %d cases de côté, marge entre bateaux ou paramètre manquant",DENSITY_MAX_SIZE);
+                exit(2);
+        }
+        char* blocked = calloc(nb_cells,1);
+        char* hit = calloc(nb_cells,1);
+        if(blocked == NULL || hit == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        Count_context context;
+        context.size = n;
+        context.blocked = blocked;
+        context.hit = hit;
+        context.nb_kinds = 0;
+        int left[64];
+        int max_size = 1;
+        for(int i = 0; i < game_config.boat_nb; i++){
+                if(board != NULL && board->hits_left[i] == 0){          //a sunk boat is known with its place
+                        Boat* boat = &boat_list[i];
+                        for(int k = 0; k < boat->boat_size; k++){
+                                blocked[(boat->y_pos + k * boat->orientation) * n + boat->x_pos + k * (1 - boat->orientation)] = 1;
+                        }
+                        continue;
+                }
+                int size = game_config.boat_sizes[i];
+                int k = 0;
+                while(k < context.nb_kinds && context.kind_size[k] != size){
+                        k++;
+                }
+                if(k == context.nb_kinds){
+                        context.kind_size[context.nb_kinds++] = size;
+                        left[k] = 0;
+                }
+                left[k]++;
+                max_size = (size > max_size) ? size : max_size;
+        }
+        if(board != NULL){
+                for(size_t i = 0; i < nb_cells; i++){
+                        blocked[i] |= (board->cells[i] == WATER_SHOT);
+                        hit[i] = (board->cells[i] == WRECK && !blocked[i]);
+                }
+        }
+        context.bits = countBits(max_size - 1);
+        int shift = (n + 1) * context.bits;
+        Count_key start = 0;
+        for(int k = 0; k < context.nb_kinds; k++){
+                context.kind_bits[k] = countBits(left[k]);
+                context.kind_shift[k] = shift;
+                shift += context.kind_bits[k];
+        }
+        if(shift > 128){
+                fprintf(stderr,"Comptage exact impossible: un état ne tient pas sur 128 bits");
+                exit(2);
+        }
+        for(int k = 0; k < context.nb_kinds; k++){
+                start |= (Count_key)left[k] << context.kind_shift[k];
+        }
+        context.fits = calloc(2 * (size_t)context.nb_kinds * nb_cells + 1,1);
+        if(context.fits == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        for(int k = 0; k < context.nb_kinds; k++){                       //what the board alone allows, checked once
+                int size = context.kind_size[k];
+                for(int orientation = 0; orientation < 2; orientation++){
+                        for(size_t cell = 0; cell < nb_cells; cell++){
+                                int x = cell % n, y = cell / n;
+                                if((orientation ? y : x) + size > n){
+                                        continue;
+                                }
+                                int free_cases = 1, wrecks = 0;
+                                for(int c = 0; c < size; c++){
+                                        size_t covered = orientation ? cell + (size_t)c * n : cell + c;
+                                        free_cases &= !blocked[covered];
+                                        wrecks += hit[covered];
+                                }
+                                context.fits[(2 * k + orientation) * nb_cells + cell] = free_cases && wrecks < size;   //a boat on wrecks only would be sunk
+                        }
+                }
+        }
+
+        Count_layer* rows = calloc(n + 1,sizeof(Count_layer));        //states before the first case of each row, kept for the backward pass
+        if(rows == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        countLayerInit(&rows[0],16);
+        countLayerAdd(&rows[0],start,1);
+        size_t max_states = 1;
+        Count_layer spare;                                              //slots of a layer done with, filled again by the next case
+        countLayerInit(&spare,16);
+        for(int y = 0; y < n; y++){                                     //forward: layouts of the cases before each state
+                Count_layer current = rows[y];
+                for(int x = 0; x < n; x++){
+                        Count_layer following = spare;
+                        countForward(&context,y * n + x,&current,&following);
+                        max_states = (following.nb > max_states) ? following.nb : max_states;
+                        if(x > 0 || probabilities == NULL){
+                                spare = current;
+                                countLayerClear(&spare);
+                        }
+                        else{
+                                countLayerInit(&spare,current.capacity);
+                        }
+                        current = following;
+                }
+                rows[y + 1] = current;
+                if(probabilities == NULL){
+                        memset(&rows[y],0,sizeof(Count_layer));         //reused as spare
+                }
+                if(progress){
+                        fprintf(stderr,"\rComptage: ligne %d/%d, %zu états",y + 1,n,current.nb);
+                }
+        }
+        countLayerFree(&spare);
+        if(progress){
+                fprintf(stderr,"\rComptage: %d lignes, %zu états au plus\n",n,max_states);
+        }
+        Count_layer* last = &rows[n];
+        long end = countFind(last,0);                                     //every boat placed, nothing left to cover
+        Count_value total = (end >= 0) ? last->entries[end].count : 0;
+
+        if(probabilities != NULL){                                        //backward: ways to complete each state, row after row from the last
+                last->after = calloc(last->nb + 1,sizeof(Count_value));
+                if(last->after == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                if(end >= 0){
+                        last->after[end] = 1;
+                }
+                Count_layer* row = malloc((n + 1) * sizeof(Count_layer));
+                if(row == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                for(int x = 1; x < n; x++){                              //the states inside a row, kept from row to row
+                        countLayerInit(&row[x],16);
+                }
+                for(int y = n - 1; y >= 0; y--){
+                        row[0] = rows[y];
+                        for(int x = 0; x + 1 < n; x++){                  //the states inside the row, computed again
+                                countLayerClear(&row[x + 1]);
+                                countForward(&context,y * n + x,&row[x],&row[x + 1]);
+                        }
+                        row[n] = rows[y + 1];
+                        for(int x = n - 1; x >= 0; x--){
+                                long double with_boat = countBackward(&context,y * n + x,&row[x],&row[x + 1]);
+                                probabilities[y * n + x] = (total != 0) ? (double)(with_boat / total) : 0.0;
+                        }
+                        countLayerFree(&rows[y + 1]);                    //no longer needed once its row is done
+                        rows[y] = row[0];
+                        if(progress){
+                                fprintf(stderr,"\rProbabilités: ligne %d/%d",n - y,n);
+                        }
+                }
+                if(progress){
+                        fprintf(stderr,"\n");
+                }
+                for(int x = 1; x < n; x++){
+                        countLayerFree(&row[x]);
+                }
+                free(row);
+        }
+        for(int y = 0; y <= n; y++){
+                countLayerFree(&rows[y]);
+        }
+        free(rows);
+        free(context.fits);
+        free(blocked);
+        free(hit);
+        return total;
+}
+
+/**
+ * @brief Counts the fleet layouts of a board, after some shots of a bot, and compares the bot with the exact probabilities.
+ *
+ * The board is the bot board of the first game of the run (seed of --seed). Once
+ * the shots are fired, the function displays the number of layouts agreeing with
+ * the board and the time taken; with the probabilities, it also displays the share
+ * of the layouts with a boat on each case (boards up to 20 cases wide) and, when
+ * shots are left to fire, the case the bot would shoot next next to the most
+ * probable case.
+ *
+ * @param[in] nb_shots Number of shots fired before counting.
+ * @param[in] bot Strategy of the shooting bot.
+ * @param[in] with_probabilities 0 to only count, faster and in less memory (see countLayouts).
+ *
+ * @note The function exits with an error message if the number of shots is negative or if counting is impossible.
+ */
+void runCount(long nb_shots, Bot_type bot, int with_probabilities){
+        if(nb_shots < 0){
+                fprintf(stderr,"Nombre de tirs invalide");
+                exit(2);
+        }
+        check_const();
+        Game* game = createGame(rngStreamSeed(game_config.seed,0));
+        startSimulatedGame(game);
+        seatBind(game,0,bot);                                   //the strategy shoots at the bot board from the player seat
+        Game_board* board = game->tab_bot;
+        int x,y;
+        for(long shot = 0; shot < nb_shots && !fleetDestroyed(board); shot++){
+                int boat_id = -1;
+                seatChoose(game,0,&x,&y);
+                Shot_result result = resolveShot(board,x,y,&boat_id);
+                seatObserve(game,0,x,y,result,boat_id);
+        }
+        int n = board->Matrix_size;
+        double* probabilities = malloc((size_t)n * n * sizeof(double));
+        if(probabilities == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        unsigned __int128 total = countLayouts(board,game->boat_tab_bot,with_probabilities ? probabilities : NULL,1);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        char digits[40];
+        printf("%s dispositions de la flotte après %d tirs (%s), comptées en %.3f s\n",countFormat(total,digits),n * n - board->nb_unshot,
+               botTypeName(bot),(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+        if(with_probabilities && n <= 20){
+                for(int i = 0; i < n; i++){
+                        for(int j = 0; j < n; j++){
+                                Case_type type = board->cells[i * n + j];
+                                if(type == WATER_SHOT || type == WRECK){
+                                        printf("   %c",type == WRECK ? 'D' : 'X');
+                                }
+                                else{
+                                        printf(" %3.0f",100 * probabilities[i * n + j]);
+                                }
+                        }
+                        printf("\n");
+                }
+        }
+        if(with_probabilities && total != 0 && !fleetDestroyed(board)){
+                int best = -1;
+                for(int i = 0; i < n * n; i++){
+                        Case_type type = board->cells[i];
+                        if((type == WATER || type == BOAT) && (best < 0 || probabilities[i] > probabilities[best])){
+                                best = i;
+                        }
+                }
+                seatChoose(game,0,&x,&y);
+                printf("Case la plus probable: (%d,%d) à %.2f%% - le bot %s vise (%d,%d) à %.2f%%\n",best % n,best / n,100 * probabilities[best],
+                       botTypeName(bot),x,y,100 * probabilities[y * n + x]);
+        }
+        free(probabilities);
+        freeGame(game);
+}
@@ -0,0 +1,221 @@
+/**
+ * @file Density.c
+ * @brief .c file containing the probability density targeting bot
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The bot counts, for every case, how many placements of the remaining enemy
+ * boats cover it while staying consistent with the misses and the sunk boats,
+ * and shoots the case covered by the most placements. Placements covering a
+ * wreck that isn't sunk yet are counted apart and win over the others, so the
+ * bot finishes the boats it has hit.
+ *
+ * All the placements of a boat are handled at once with bitboard masks: the
+ * legal starting cases are the free cases whose following cases are free too,
+ * and the per-case counts are kept in bit-sliced counters (plane p holding bit p
+ * of every counter), so one decision is a few hundred 128-bit operations.
+ */
+#include "header.h"
+
+/**
+ * @brief Adds one to the bit-sliced counters of every case set in a mask.
+ *
+ * @param[in,out] planes Counter planes, plane p holding bit p of each counter.
+ * @param[in] mask Cases to increment.
+ */
+static void densityAdd(Bitmask* planes, Bitmask mask){
+        for(int p = 0; p < DENSITY_PLANES && mask != 0; p++){        //ripple carry through the planes
+                Bitmask carry = planes[p] & mask;
+                planes[p] ^= mask;
+                mask = carry;
+        }
+}
+
+/**
+ * @brief Keeps, among candidate cases, those whose bit-sliced counter is the highest.
+ *
+ * @param[in] planes Counter planes, plane p holding bit p of each counter.
+ * @param[in] candidates Cases to compare.
+ * @return The candidates sharing the maximum counter value.
+ */
+static Bitmask densityMax(Bitmask* planes, Bitmask candidates){
+        for(int p = DENSITY_PLANES - 1; p >= 0; p--){                //from the most significant bit, keep the cases having it when some do
+                Bitmask with_bit = candidates & planes[p];
+                if(with_bit != 0){
+                        candidates = with_bit;
+                }
+        }
+        return candidates;
+}
+
+/**
+ * @brief Accumulates every placement of a boat consistent with the observed board.
+ *
+ * @param[in,out] planes Counters of the placements on free cases.
+ * @param[in,out] hit_planes Counters of the placements also covering a wreck not sunk yet.
+ * @param[in] free Cases where a boat may still be.
+ * @param[in] hits Wrecks of boats not sunk yet.
+ * @param[in] boat_size Size of the boat.
+ */
+static void densityAccumulate(Bitmask* planes, Bitmask* hit_planes, Bitmask free, Bitmask hits, int boat_size){
+        for(int orientation = 0; orientation < (boat_size == 1 ? 1 : 2); orientation++){
+                int step = (orientation == 0) ? 1 : BITBOARD_STRIDE;
+                Bitmask starts = free;
+                Bitmask covers_hit = hits;
+                for(int k = 1; k < boat_size; k++){                  //a start is legal when the k-th following case is free too
+                        starts &= free >> (k * step);
+                        covers_hit |= hits >> (k * step);
+                }
+                Bitmask hit_starts = starts & covers_hit;
+                for(int k = 0; k < boat_size; k++){                  //each legal placement adds one to its boat_size cases
+                        densityAdd(planes,starts << (k * step));
+                        if(hit_starts != 0){
+                                densityAdd(hit_planes,hit_starts << (k * step));
+                        }
+                }
+        }
+}
+
+/**
+ * @brief Rebuilds what the shooter knows about a board.
+ *
+ * The observed board is read from the bitboard of the target: misses and the
+ * cases of sunk boats are blocked, wrecks of boats still alive must be covered
+ * by one of the remaining boats. Only the sunk status of the enemy boats is read
+ * from the hit counters of the board and their list, as it is announced in a real game.
+ *
+ * @param[in] board Pointer to the targeted game board structure, must fit in a bitboard.
+ * @param[in] boat_list Pointer to the array of the targeted boats.
+ * @param[out] free Cases where a remaining boat may be.
+ * @param[out] hits Wrecks of boats not sunk yet.
+ * @param[out] sizes Sizes of the boats not sunk yet, from the biggest to the smallest (room for every boat of the fleet).
+ * @return The number of boats not sunk yet.
+ *
+ * @note The function exits with an error message if a pointer is NULL.
+ */
+int boardObservation(Game_board* board, Boat* boat_list, Bitmask* free, Bitmask* hits, int* sizes){
+        if (board == NULL || boat_list == NULL || free == NULL || hits == NULL || sizes == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Bitmask shots = board->bits.shots;
+        Bitmask sunk = 0;
+        int nb = 0;
+        for(int i = 0; i < game_config.boat_nb; i++){
+                if(board->hits_left[i] == 0){
+                        sunk |= boatMask(&boat_list[i]);
+                        continue;
+                }
+                int j = nb;                                     //insertion sort, the biggest boats first
+                while(j > 0 && sizes[j - 1] < boat_list[i].boat_size){
+                        sizes[j] = sizes[j - 1];
+                        j--;
+                }
+                sizes[j] = boat_list[i].boat_size;
+                nb++;
+        }
+        *hits = shots & board->bits.boats & ~sunk;
+        *free = bitInsideMask(board->Matrix_size) & ~(shots & ~*hits);   //wrecks of boats still alive may be covered again
+        return nb;
+}
+
+/**
+ * @brief Rebuilds what the shooter knows about a board as one mask per row.
+ *
+ * Same observation as boardObservation, read from the cases of the board so it
+ * works on boards too big for a bitboard: bit x of row y stands for the case (x,y).
+ *
+ * @param[in] board Pointer to the targeted game board structure, at most DENSITY_MAX_SIZE wide.
+ * @param[in] boat_list Pointer to the array of the targeted boats.
+ * @param[out] free_rows Cases where a remaining boat may be.
+ * @param[out] hit_rows Wrecks of boats not sunk yet.
+ * @param[out] unshot_rows Cases not shot yet.
+ * @param[out] sizes Sizes of the boats not sunk yet, from the biggest to the smallest.
+ * @return The number of boats not sunk yet.
+ */
+static int boardRows(Game_board* board, Boat* boat_list, uint64_t* free_rows, uint64_t* hit_rows, uint64_t* unshot_rows, int* sizes){
+        int n = board->Matrix_size;
+        for(int y = 0; y < n; y++){
+                const Case_type* row = board->cells + (size_t)y * n;
+                uint64_t wrecks = 0, unshot = 0;
+                for(int x = 0; x < n; x++){
+                        wrecks |= (uint64_t)(row[x] == WRECK) << x;
+                        unshot |= (uint64_t)(row[x] == WATER || row[x] == BOAT) << x;
+                }
+                free_rows[y] = wrecks | unshot;            //every case but the misses
+                hit_rows[y] = wrecks;
+                unshot_rows[y] = unshot;
+        }
+        int nb = 0;
+        for(int i = 0; i < game_config.boat_nb; i++){
+                Boat* boat = &boat_list[i];
+                if(board->hits_left[i] == 0){                   //the cases of a sunk boat are blocked
+                        for(int k = 0; k < boat->boat_size; k++){
+                                int x = boat->x_pos + (boat->orientation == 0 ? k : 0);
+                                int y = boat->y_pos + (boat->orientation == 0 ? 0 : k);
+                                free_rows[y] &= ~((uint64_t)1 << x);
+                                hit_rows[y] &= ~((uint64_t)1 << x);
+                        }
+                        continue;
+                }
+                int j = nb;                                     //insertion sort, the biggest boats first
+                while(j > 0 && sizes[j - 1] < boat->boat_size){
+                        sizes[j] = sizes[j - 1];
+                        j--;
+                }
+                sizes[j] = boat->boat_size;
+                nb++;
+        }
+        return nb;
+}
+
+/**
+ * @brief Chooses the case targeted by the density bot.
+ *
+ * The counts are computed on the board observed by boardObservation. Boards too
+ * big for a bitboard are observed row by row and counted by the density kernel
+ * of their size, and the bot falls back to botTarget on boards wider than
+ * DENSITY_MAX_SIZE.
+ *
+ * @param[in] board Pointer to the targeted game board structure.
+ * @param[in] boat_list Pointer to the array of the targeted boats.
+ * @param[out] x X-coordinate chosen by the bot.
+ * @param[out] y Y-coordinate chosen by the bot.
+ * @param[in,out] rng Pointer to the random generator used by the fallback.
+ *
+ * @note The function exits with an error message if a pointer is NULL.
+ */
+void densityTarget(Game_board* board, Boat* boat_list, int* x, int* y, Rng* rng){
+        if (board == NULL || boat_list == NULL || x == NULL || y == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        int n = board->Matrix_size;
+        if(!bitBoardFits(n)){
+                if(n > DENSITY_MAX_SIZE){
+                        botTarget(board,x,y,rng);
+                        return;
+                }
+                uint64_t free_rows[n], hit_rows[n], unshot_rows[n];
+                int sizes[game_config.boat_nb];
+                int nb = boardRows(board,boat_list,free_rows,hit_rows,unshot_rows,sizes);
+                board->kernels->density(free_rows,hit_rows,unshot_rows,sizes,nb,n,x,y);
+                return;
+        }
+        Bitmask free, hits;
+        int sizes[game_config.boat_nb];
+        int nb = boardObservation(board,boat_list,&free,&hits,sizes);
+
+        Bitmask planes[DENSITY_PLANES] = {0};
+        Bitmask hit_planes[DENSITY_PLANES] = {0};
+        for(int i = 0; i < nb; i++){
+                densityAccumulate(planes,hit_planes,free,hits,sizes[i]);
+        }
+
+        Bitmask candidates = bitInsideMask(board->Matrix_size) & ~board->bits.shots;
+        candidates = densityMax(hit_planes,candidates);
+        candidates = densityMax(planes,candidates);
+        int cell = bitFirstCell(candidates);                    //first case among the best ones
+        *x = cell % BITBOARD_STRIDE;
+        *y = cell / BITBOARD_STRIDE;
+}
@@ -6,26 +6,103 @@
  */
 #include "header.h"
 
+/**
+ * @brief Gives the size of the block holding a whole game of the current configuration.
+ *
+ * @return The size of the block, rounded up with ARENA_ROUND so blocks can follow each other.
+ */
+size_t gameBlockSize(){
+        return ARENA_ROUND(sizeof(Game)) + 2 * gameBoardBlockSize(game_config.plate_size) + 2 * ARENA_ROUND(game_config.boat_nb * sizeof(Boat));
+}
+
+/**
+ * @brief Lays out a game in a block of memory.
+ *
+ * The game structure, its two game boards and its two boat arrays all live in
+ * the block, so a game costs a single allocation and is freed at once. The game
+ * still has to be started with gameReset.
+ *
+ * @param[out] block Block of gameBlockSize() bytes, aligned for a Bitmask.
+ * @return A pointer to the game, at the start of the block.
+ */
+Game* gamePlace(void* block){
+        size_t board_size = gameBoardBlockSize(game_config.plate_size);
+        char* next = (char*)block + ARENA_ROUND(sizeof(Game));
+        Game* game = block;
+        game->tab_player = gameBoardPlace(next,game_config.plate_size);
+        game->tab_bot = gameBoardPlace(next + board_size,game_config.plate_size);
+        next += 2 * board_size;
+        game->boat_tab_player = (Boat*)next;
+        game->boat_tab_bot = (Boat*)(next + ARENA_ROUND(game_config.boat_nb * sizeof(Boat)));
+        game->renderer = NULL;
+        game->turn = 0;
+        game->shots[0] = 0;
+        game->shots[1] = 0;
+        game->winner = -1;
+        game->seats[0].strategy = NULL;
+        game->seats[1].strategy = NULL;
+        game->input = -1;
+        return game;
+}
+
+/**
+ * @brief Starts a game again in place, as createGame would create it with the same seed.
+ *
+ * The function seeds the random generator of the game, draws new player and enemy
+ * fleets into the boat arrays and clears the turn, the shots, the winner and the seats, without
+ * any allocation. Every random draw of the game comes from its own generator, so
+ * several games can be played at the same time on different threads.
+ *
+ * @param[in,out] game Pointer to the game, created by createGame or laid out by gamePlace.
+ * @param[in] seed Seed of the random generator of the game.
+ *
+ * @note The function exits with an error message if the game pointer is NULL.
+ */
+void gameReset(Game* game, uint64_t seed){
+        if(game == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        rngSeed(&game->rng,seed);
+        seatRelease(game);                                     //the strategies of the seats start again
+        if(game->renderer != NULL){                            //the next display starts a new frame
+                game->renderer->drawn = 0;
+        }
+        game->turn = 0;
+        game->shots[0] = 0;
+        game->shots[1] = 0;
+        game->winner = -1;
+        game->input = -1;
+        uint64_t start = statsClock();
+        drawBoatList(game->boat_tab_player,&game->rng);
+        drawBoatList(game->boat_tab_bot,&game->rng);
+        statsThread()->fleet_ns += statsClock() - start;
+        game->tab_player->log = NULL;
+        game->tab_bot->log = NULL;
+        if(game_config.log != NULL){                           //--log: the game is rebuilt from its seed
+                moveLogGame(game_config.log,game,seed);
+        }
+}
+
 /**
  * @brief Creates a new game with player and enemy game boards, as well as boat arrays.
  *
- * The function allocates memory for the game structure, initializes player and enemy
- * boat arrays, and creates player and enemy game boards.
+ * The function allocates one block for the whole game, lays it out with gamePlace
+ * and starts it with gameReset.
  *
- * @return A pointer to the created game structure.
+ * @param[in] seed Seed of the random generator of the game.
+ * @return A pointer to the created game structure, to be freed with freeGame.
  *
  * @note The function exits with an error message if memory allocation fails.
  */
-Game* createGame(){
-        Game* game = malloc(sizeof(Game));
-        if(game == NULL){
+Game* createGame(uint64_t seed){
+        void* block = aligned_alloc(16,gameBlockSize());
+        if(block == NULL){
                 fprintf(stderr,"Erreur lors de l'allocation");
                 exit(1);
         }
-        game->boat_tab_player = createBoatList();
-        game->boat_tab_bot = createBoatList();
-        game->tab_player = createGameBoard(PLATE_SIZE);
-        game->tab_bot = createGameBoard(PLATE_SIZE);
+        Game* game = gamePlace(block);
+        gameReset(game,seed);
         return game;
 }
 
@@ -33,17 +110,22 @@ Game* createGame(){
 /**
  * @brief Executes the main game loop, allowing the player to take turns and play against the enemy bot.
  *
- * The function creates the game, initializes player and enemy game boards, places boats, and executes
- * the main game loop until one of the players wins or loses. It displays the game status at each turn.
+ * The function creates the game, initializes player and enemy game boards, places boats, and steps
+ * the game with gameStep until one of the players wins or loses, each seat playing with its strategy.
+ * The loop is the only part which waits: it asks the coordinates of a BOT_HUMAN seat when the game
+ * waits for them, and displays the game status with a pause after each shot.
+ * The game is seeded from --seed (the current time by default), so it can be played again exactly.
  * At the end, the function free all allocated memory.
  *
+ * @param[in] bot_player Strategy of the player seat.
+ * @param[in] bot_ennemy Strategy of the enemy seat.
+ *
  * @note The function exits with an error message if memory allocation fails during game creation.
  */
-void mainGame(){
-        check_const();                  //check if PLATE_SIZE and BOAT_NB are correct
-        int nbBoatLeftPlayer = 5;
-        int nbBoatLeftBot = 5;
-        Game* game = createGame();
+void mainGame(Bot_type bot_player, Bot_type bot_ennemy){
+        check_const();                  //check if the size of the board and the fleet are correct
+        Game* game = createGame(rngStreamSeed(game_config.seed,0));    //the game 0 of the seed, as in the other modes
+        printf("Graine de la partie: %llu ('--seed' pour la rejouer)\n",(unsigned long long)game_config.seed);
         gameBoardInit(game->tab_bot);
         gameBoardInit(game->tab_player);
         printf("Création des tableaux ...\n");
@@ -52,17 +134,39 @@ void mainGame(){
         boatPlacement(game->tab_player,game->boat_tab_player);
         printf("Placement des bateaux ...\n\n");
         sleep(2);
-        printf(" --- VOTRE TABLEAU --- \n\n");
-        gameBoardDisplay(game->tab_player);
-        while( nbBoatLeftPlayer != 0 && nbBoatLeftBot !=0){
-                playerTurn(game);
-                nbBoatLeftBot = howManyAlive(game->boat_tab_bot,game->tab_bot);
-                printf("Bateaux restants ennemis: %d \n",nbBoatLeftBot);
-                ennemyTurn(game);       
-                nbBoatLeftPlayer = howManyAlive(game->boat_tab_player,game->tab_player);
-                printf("Il vous reste %d bateaux\n",nbBoatLeftPlayer);
+        seatBind(game,0,bot_player);
+        seatBind(game,1,bot_ennemy);
+        gameDisplay(game);
+        Game_event event;
+        Game_step step;
+        while(1){
+                if(game->turn == 1 && game->winner < 0 && !bot_ennemy->input){
+                        printf("L'ennemi se prépare à tirer !\n");
+                        sleep(2);
+                }
+                if((step = gameStep(game,&event)) == GAME_OVER){
+                        break;
+                }
+                if(step == GAME_WAIT){                                  //a human seat: the game waits for its case
+                        int x = getMissile_X();
+                        int y = getMissile_Y();
+                        gameInput(game,x,y);
+                        continue;
+                }
+                shotDisplay(&event);
+                sleep(2);
+                gameDisplay(game);
+                sleep(2);
+                if(game->turn != event.seat || game->winner >= 0){     //the hand passes or the game is over
+                        if(event.seat == 0){
+                                printf("Bateaux restants ennemis: %d \n",howManyAlive(game->boat_tab_bot,game->tab_bot));
+                        }
+                        else{
+                                printf("Il vous reste %d bateaux\n",howManyAlive(game->boat_tab_player,game->tab_player));
+                        }
+                }
         }
-        if(nbBoatLeftBot == 0){
+        if(game->winner == 0){
                 printf("Félicitations vous avez gagné la partie !\n");
         }
         else{
@@ -91,7 +195,7 @@ void menu(){
                         clearInputBuffer();
                 }
                 if(res == 1){
-                        mainGame();
+                        mainGame(BOT_HUMAN,BOT_RANDOM);
                 }
                 else if(res == 2){
                         printf("Explications du jeu:\n");
@@ -109,76 +213,69 @@ void menu(){
 }
 
 /**
- * @brief Checks the validity of constants (PLATE_SIZE and BOAT_NB) to ensure a valid game configuration.
+ * @brief Checks the validity of the configuration (size of the board and fleet) to ensure a valid game configuration.
  *
  * The function performs checks to ensure that the number of boats and the size of the game board are within
- * reasonable limits. It exits with an error message if the conditions are not met.
+ * reasonable limits: every boat must fit in a row, and the boats may cover at most half of the board so
+ * that a fleet can always be placed quickly, each boat counting with its no-touch margin. It exits with an error message if the conditions are not met.
  *
  * @note The function exits with an error message if the conditions for a valid game configuration are not met.
  */
 void check_const(){
-        if(PLATE_SIZE - BOAT_NB < PLATE_SIZE/5 || BOAT_NB < 1  || PLATE_SIZE < 2){                   //hasardous maths to determine if there are too many boats for the size of the board
-                fprintf(stderr,"Il y a trop de bateaux pour la taille du plateaux");
-                exit(3);
-        }
-        if(BOAT_NB < 1  || PLATE_SIZE < 2){
+        if(game_config.boat_nb < 1  || game_config.plate_size < 2 || game_config.max_boat_size > game_config.plate_size){
                 fprintf(stderr,"La taille du plateau ou le nombre de bateaux est invalide");
                 exit(4);
         }
+        long cells = 0;
+        long margin = game_config.margin;
+        for(int i = 0; i < game_config.boat_nb; i++){          //each boat with the margin on one side of each direction
+                cells += (game_config.boat_sizes[i] + margin) * (1 + margin);
+        }
+        if(2 * cells > ((long)game_config.plate_size + margin) * (game_config.plate_size + margin)){
+                fprintf(stderr,"Il y a trop de bateaux pour la taille du plateaux");
+                exit(3);
+        }
 }
 
 /**
  * @brief Frees the memory allocated for a Game structure.
  *
- * This function deallocates memory for the Game structure, including the boat arrays
- * (boat_tab_player and boat_tab_bot) and the game boards (tab_player and tab_bot).
- * It also calls the corresponding function to free the memory of each game board.
+ * The boat arrays and the game boards live in the block of the game, so the
+ * renderer, if the game was displayed, and the block are all there is to free.
  *
- * @param game A pointer to the Game structure to be freed.
+ * @param game A pointer to the Game structure to be freed, created by createGame.
  *
- * @note If the game pointer is NULL, nothing is freed.
+ * @note If the game pointer is NULL, nothing is freed. A game taken from a Game_pool must be given back with gamePoolGive instead.
  */
 void freeGame(Game* game){
     if (game == NULL) {
         return;  // Nothing to free if the game pointer is NULL
     }
 
-    // Free boat arrays
-    free(game->boat_tab_player);
-    free(game->boat_tab_bot);
-
-    // Free game boards
-    freeGameBoard(game->tab_player);
-    freeGameBoard(game->tab_bot);
+    // Reset the strategies of the seats, then free the renderer, if the game was displayed
+    seatRelease(game);
+    rendererFree(game->renderer);
 
-    // Free the Game structure itself
+    // Free the block holding the Game structure, its boards and its boats
     free(game);
 }
 
 /**
  * @brief Frees the memory allocated for a Game_board structure.
  *
- * This function deallocates memory for the Game_board structure, including freeing
- * individual rows of the matrix and the matrix itself. If the board pointer is NULL,
- * nothing is freed.
+ * This function deallocates memory for the Game_board structure, including the
+ * matrix and its cases, which are stored in the same block. If the board pointer
+ * is NULL, nothing is freed.
  *
- * @param board A pointer to the Game_board structure to be freed.
+ * @param board A pointer to the Game_board structure to be freed, created by createGameBoard.
  *
- * @note If the board pointer is NULL, nothing is freed.
+ * @note If the board pointer is NULL, nothing is freed. The boards of a game are freed with their game.
  */
 void freeGameBoard(Game_board* board){
     if (board == NULL) {
         return;  // Nothing to free if the board pointer is NULL
     }
 
-    // Free matrix rows
-    for (int i = 0; i < board->Matrix_size; i++) {
-        free(board->matrix[i]);
-    }
-
-    // Free matrix
-    free(board->matrix);
-
-    // Free the Game_board structure itself
+    // Free the block holding the Game_board structure, its rows and its cases
     free(board);
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+/**
+ * @file GamePool.c
+ * @brief .c file containing the pools of games reset and reused in place
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * A game lives in one block (see gamePlace), and a pool carves these blocks
+ * GAME_POOL_CHUNK at a time out of a bigger arena block. A finished game is
+ * given back to its pool and the next game taken from the pool is the same
+ * memory started again with gameReset, so a long run of simulations allocates
+ * once for the few games it plays at the same time instead of once per game.
+ * Every thread has its own pool (gamePoolThread), so the simulation threads
+ * never share a lock, nor call the allocator once their pool is warm.
+ */
+#include "header.h"
+
+static pthread_key_t thread_pool_key;                    /**< Frees the pool of a thread when it ends. */
+static pthread_once_t thread_pool_once = PTHREAD_ONCE_INIT;
+static __thread Game_pool* thread_pool = NULL;           /**< Pool of the thread, created by its first game. */
+
+/**
+ * @brief Creates an empty pool of games.
+ *
+ * @return A pointer to the created pool, to be freed with gamePoolFree.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+Game_pool* gamePoolCreate(){
+        Game_pool* pool = malloc(sizeof(Game_pool));
+        if(pool == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        pool->chunks = NULL;
+        pool->nb_chunks = 0;
+        pool->free_games = NULL;
+        pool->nb_free = 0;
+        return pool;
+}
+
+/**
+ * @brief Adds an arena block of GAME_POOL_CHUNK games to a pool, all of them free.
+ *
+ * @param[in,out] pool Pointer to the pool.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+static void gamePoolGrow(Game_pool* pool){
+        size_t block_size = gameBlockSize();
+        char* chunk = aligned_alloc(16,GAME_POOL_CHUNK * block_size);
+        char** chunks = realloc(pool->chunks,(pool->nb_chunks + 1) * sizeof(char*));
+        Game** free_games = realloc(pool->free_games,(size_t)(pool->nb_chunks + 1) * GAME_POOL_CHUNK * sizeof(Game*));
+        if(chunk == NULL || chunks == NULL || free_games == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        chunks[pool->nb_chunks++] = chunk;
+        pool->chunks = chunks;
+        pool->free_games = free_games;
+        for(int i = GAME_POOL_CHUNK - 1; i >= 0; i--){           //the first game of the block is taken first
+                pool->free_games[pool->nb_free++] = gamePlace(chunk + i * block_size);
+        }
+}
+
+/**
+ * @brief Takes a game from a pool and starts it.
+ *
+ * The game is the same as the one createGame would create with the same seed.
+ *
+ * @param[in,out] pool Pointer to the pool.
+ * @param[in] seed Seed of the random generator of the game.
+ * @return A pointer to the game, to be given back with gamePoolGive.
+ *
+ * @note The function exits with an error message if the pool pointer is NULL or if memory allocation fails.
+ */
+Game* gamePoolTake(Game_pool* pool, uint64_t seed){
+        if(pool == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        if(pool->nb_free == 0){
+                gamePoolGrow(pool);
+        }
+        Game* game = pool->free_games[--pool->nb_free];
+        gameReset(game,seed);
+        return game;
+}
+
+/**
+ * @brief Gives a game back to the pool it was taken from, so it can be reused.
+ *
+ * @param[in,out] pool Pointer to the pool.
+ * @param[in] game Pointer to the game, taken from this pool.
+ *
+ * @note The function exits with an error message if the pool pointer is NULL. If the game pointer is NULL, nothing is given back.
+ */
+void gamePoolGive(Game_pool* pool, Game* game){
+        if(pool == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        if(game == NULL){
+                return;
+        }
+        seatRelease(game);                                      //the strategies of the seats may hold memory of their own
+        rendererFree(game->renderer);                           //the only part of a game outside its block
+        game->renderer = NULL;
+        pool->free_games[pool->nb_free++] = game;
+}
+
+/**
+ * @brief Frees a pool and all of its games.
+ *
+ * @param[in] pool Pointer to the pool, whose games must all have been given back.
+ *
+ * @note If the pool pointer is NULL, nothing is freed.
+ */
+void gamePoolFree(Game_pool* pool){
+        if(pool == NULL){
+                return;
+        }
+        for(int i = 0; i < pool->nb_chunks; i++){
+                free(pool->chunks[i]);
+        }
+        free(pool->chunks);
+        free(pool->free_games);
+        free(pool);
+}
+
+/**
+ * @brief Frees the pool of a thread that ends.
+ *
+ * @param[in] pool Pointer to the pool of the thread.
+ */
+static void gamePoolThreadFree(void* pool){
+        gamePoolFree(pool);
+}
+
+/**
+ * @brief Creates the key freeing the pool of each thread.
+ */
+static void gamePoolKeyInit(){
+        pthread_key_create(&thread_pool_key,gamePoolThreadFree);
+}
+
+/**
+ * @brief Gives the pool of the calling thread, created on its first call.
+ *
+ * The pool is freed when the thread ends; the games taken from it must be given
+ * back by the same thread before.
+ *
+ * @return A pointer to the pool of the thread.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+Game_pool* gamePoolThread(){
+        if(thread_pool == NULL){
+                pthread_once(&thread_pool_once,gamePoolKeyInit);
+                thread_pool = gamePoolCreate();
+                pthread_setspecific(thread_pool_key,thread_pool);
+        }
+        return thread_pool;
+}
@@ -7,46 +7,79 @@
 #include "header.h"
 
 /**
- * @brief Creates a game board with the specified size (PLATE_SIZE).
+ * @brief Gives the size of the block holding a whole game board.
  *
- * The function allocates memory for a game board matrix and initializes its size.
+ * @param[in] size Size of the game board.
+ * @return The size of the block, rounded up with ARENA_ROUND so blocks can follow each other.
+ */
+size_t gameBoardBlockSize(int size){
+        size_t nb_cells = (size_t)size * size;
+        return ARENA_ROUND(sizeof(Game_board)) + ARENA_ROUND(size * sizeof(Case_type*) + nb_cells * (sizeof(Case_type) + 3 * sizeof(int)) + game_config.boat_nb * sizeof(int));
+}
+
+/**
+ * @brief Lays out a game board in a block of memory.
+ *
+ * The structure comes first, followed by the pointer to the start of each row,
+ * the cases stored row after row, the index of the boat on each case, the
+ * intact cases of each boat of the fleet and the list of the cases not shot yet
+ * with the position of each case in it. Nothing is allocated, so a board can
+ * live inside a bigger block such as the one of a game.
  *
+ * @param[out] block Block of gameBoardBlockSize(size) bytes, aligned for a Bitmask.
  * @param[in] size Size of the game board.
- * @return A pointer to the created game board structure.
+ * @return A pointer to the game board, at the start of the block.
+ */
+Game_board* gameBoardPlace(void* block, int size){
+        Game_board* board = block;
+        board->Matrix_size = size;
+        board->kernels = boardKernels(size);
+        size_t nb_cells = (size_t)size * size;
+        board->matrix = (Case_type**)((char*)block + ARENA_ROUND(sizeof(Game_board)));   //row pointers, cases, boat index, hit counters
+        board->cells = (Case_type*)(board->matrix + size);
+        board->boat_ids = (int*)(board->cells + nb_cells);
+        board->hits_left = board->boat_ids + nb_cells;
+        board->boats_alive = 0;
+        board->unshot = board->hits_left + game_config.boat_nb;
+        board->unshot_pos = board->unshot + nb_cells;
+        board->nb_unshot = 0;
+        board->log = NULL;
+        for (int i = 0; i < size; i++){
+                board->matrix[i] = board->cells + (size_t)i * size;
+        }
+        return board;
+}
+
+/**
+ * @brief Creates a game board with the specified size.
+ *
+ * The function allocates one block for the game board and lays it out with gameBoardPlace.
+ *
+ * @param[in] size Size of the game board.
+ * @return A pointer to the created game board structure, to be freed with freeGameBoard.
  *
  * @note The function exits with an error message if the size is invalid or if memory
  * allocation fails.
  */
 Game_board* createGameBoard(int size){
-        if((size < 1) || size > PLATE_SIZE ){
+        if(size < 1){
                 fprintf(stderr,"taille incorrecte");
                 exit(1);
         } 
-        Game_board* board = malloc(sizeof(Game_board));
-        if (board == NULL){
-                fprintf(stderr,"Erreur lors de l'allocation");
-                exit(1);
-        }
-        board->Matrix_size = size;
-        board->matrix = malloc(size * sizeof(Case_type*));
-        if(board->matrix == NULL){
+        void* block = aligned_alloc(16,gameBoardBlockSize(size));
+        if (block == NULL){
                 fprintf(stderr,"Erreur lors de l'allocation");
                 exit(1);
         }
-        for (int i = 0; i < size; i++){
-                board->matrix[i] = malloc(size * sizeof(Case_type));
-                if(board->matrix[i] == NULL){
-                        fprintf(stderr,"Erreur lors de l'allocation");
-                        exit(1);
-                }
-        }
-        return board;
+        return gameBoardPlace(block,size);
 }
 
 /**
  * @brief Initializes a game board with water in all positions.
  *
- * The function sets all positions on the game board matrix to the WATER type.
+ * The function sets all positions on the game board matrix to the WATER type,
+ * as well as its bitboard copy when the board is small enough, and empties the
+ * fleet of the board.
  *
  * @param[in] board Pointer to the game board structure.
  *
@@ -57,10 +90,15 @@ void gameBoardInit(Game_board* board){
                 fprintf(stderr,"Erreur lors de l'allocation");
                 exit(1);
         }
-        for(int i = 0; i < board->Matrix_size; i++){
-                for( int j=0; j < board->Matrix_size;j++){
-                        board->matrix[i][j] = WATER;
-                }
+        for(size_t i = 0; i < (size_t)board->Matrix_size * board->Matrix_size; i++){
+                board->cells[i] = WATER;
+                board->unshot[i] = i;
+                board->unshot_pos[i] = i;
+        }
+        board->nb_unshot = board->Matrix_size * board->Matrix_size;
+        board->boats_alive = 0;
+        if(bitBoardFits(board->Matrix_size)){                  //keep the bitboard copy in sync
+                bitBoardInit(&board->bits);
         }
 }
 
@@ -68,7 +106,7 @@ void gameBoardInit(Game_board* board){
  * @brief Displays the content of the game board.
  *
  * The function prints the content of the game board matrix, representing different
- * types of cases with symbols. The display depends of the PLATE_SIZE value
+ * types of cases with symbols. The board is formatted in one buffer and written at once.
  *
  * @param[in] board Pointer to the game board structure.
  *
@@ -79,58 +117,7 @@ void gameBoardDisplay(Game_board* board){
                 fprintf(stderr,"Erreur lors de l'allocation");
                 exit(1);
         }
-        if(PLATE_SIZE < 11){
-                printf("   ");
-                for (int k = 0; k < board->Matrix_size;k++){
-                        printf("%d ",k);
-                }
-                printf("\n");
-                for(int i = 0; i < board->Matrix_size ; i++){ 
-                        printf("%d  ",i);
-                        for(int j = 0; j < board->Matrix_size ; j++){                 //print symbol based on the case type
-                                if (board->matrix[i][j] == WATER){
-                                        printf("~ ");
-                                }
-                                if (board->matrix[i][j] == WATER_SHOT){
-                                        printf("X ");
-                                }
-                                if (board->matrix[i][j] == BOAT){
-                                        printf("O ");
-                                }
-                                if (board->matrix[i][j] == WRECK){
-                                        printf("D ");
-                                }
-                        }
-                        printf("\n");
-                }
-                printf("\n");
-        }
-        else{
-                printf("     ");
-                for (int k = 0; k < board->Matrix_size;k++){
-                        printf("%02d ",k);
-                }
-                printf("\n");
-                for(int i = 0; i < board->Matrix_size ; i++){ 
-                        printf("%02d   ",i);
-                        for(int j = 0; j < board->Matrix_size ; j++){                 //print symbol based on the case type
-                                if (board->matrix[i][j] == WATER){
-                                        printf("~  ");
-                                }
-                                if (board->matrix[i][j] == WATER_SHOT){
-                                        printf("X  ");
-                                }
-                                if (board->matrix[i][j] == BOAT){
-                                        printf("O  ");
-                                }
-                                if (board->matrix[i][j] == WRECK){
-                                        printf("D  ");
-                                }
-                        }
-                        printf("\n");
-                }
-                printf("\n");
-        }
+        renderBoard(board,0);
 }
 
 /**
@@ -148,50 +135,5 @@ void ennemyBoardDisplay(Game_board* board){
                 fprintf(stderr,"Erreur lors de l'allocation");
                 exit(1);
         }
-        if(PLATE_SIZE < 11){
-                printf("   ");
-                for (int k = 0; k < board->Matrix_size;k++){
-                       printf("%d ",k);
-                }
-                printf("\n");
-                for(int i = 0; i < board->Matrix_size ; i++){ 
-                        printf("%d  ",i);
-                        for(int j = 0; j < board->Matrix_size ; j++){
-                                if (board->matrix[i][j] == WRECK ){
-                                        printf("D ");
-                                }
-                                else if (board->matrix[i][j] == WATER_SHOT){
-                                        printf("X ");
-                                }
-                                else{
-                                        printf("~ ");
-                                }
-                        }
-                        printf("\n");
-                }
-                printf("\n");
-        }
-        else{
-                printf("     ");
-                for (int k = 0; k < board->Matrix_size;k++){
-                       printf("%02d ",k);
-                }
-                printf("\n");
-                for(int i = 0; i < board->Matrix_size ; i++){ 
-                        printf("%02d   ",i);
-                        for(int j = 0; j < board->Matrix_size ; j++){
-                                if (board->matrix[i][j] == WRECK ){
-                                        printf("D  ");
-                                }
-                                else if (board->matrix[i][j] == WATER_SHOT){
-                                        printf("X  ");
-                                }
-                                else{
-                                        printf("~  ");
-                                }
-                        }
-                        printf("\n");
-                }
-                printf("\n");
-        }
-}
\ No newline at end of file
+        renderBoard(board,1);
+}
@@ -0,0 +1,195 @@
+/**
+ * @file Kernels.c
+ * @brief .c file containing the board kernels specialized for the common board sizes
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The hot loops on a board (boat placement and density accumulation) are
+ * written once in DEFINE_BOARD_KERNELS and DEFINE_DENSITY_KERNEL and
+ * instantiated for 8x8, 10x10 and 16x16 boards with the size as a compile-time
+ * constant, so the compiler can fully unroll the loops on rows and vectorize
+ * them, and once with the size read at runtime as the generic fallback. Every board gets the table
+ * of its size when it is created (boardKernels).
+ *
+ * Boards up to 10x10 get their density counts from the 128-bit bitboard kernel
+ * of Density.c, which beats per-row masks there, so the density kernels below
+ * serve the wider boards. They work on one mask per row of the board: the legal
+ * starts of a horizontal boat are found with shifts inside each row, those of a
+ * vertical boat with an AND of consecutive rows, and the per-case counts are
+ * bit-sliced counters (plane p holding bit p of every counter of a row).
+ */
+#include "header.h"
+
+/**
+ * @brief Defines the density kernel of a board size.
+ *
+ * @param SUFFIX Suffix of the generated function names.
+ * @param N Size of the board: a constant, or n_board for the generic kernel. A constant kernel also serves the smaller
+ * boards, whose rows beyond n_board are left empty so no boat is placed on them.
+ * @param ROW Unsigned type holding one row of the board.
+ */
+#define DEFINE_DENSITY_KERNEL(SUFFIX, N, ROW)                                                           \
+                                                                                                        \
+static void densityAdd##SUFFIX(int n_board, ROW planes[][N], const ROW* mask_rows){                     \
+        const int n = (N);                                                                              \
+        (void)n_board;                                  /* only read by the generic kernel */           \
+        ROW carry[N];                                                                                   \
+        for(int y = 0; y < n; y++){                                                                     \
+                carry[y] = mask_rows[y];                                                                \
+        }                                                                                               \
+        for(int p = 0; p < DENSITY_PLANES; p++){                /* ripple carry through the planes */   \
+                ROW any = 0;                                                                            \
+                for(int y = 0; y < n; y++){                                                             \
+                        ROW next = planes[p][y] & carry[y];                                             \
+                        planes[p][y] ^= carry[y];                                                       \
+                        carry[y] = next;                                                                \
+                        any |= next;                                                                    \
+                }                                                                                       \
+                if(any == 0){                                                                           \
+                        break;                                                                          \
+                }                                                                                       \
+        }                                                                                               \
+}                                                                                                       \
+                                                                                                        \
+static void densityMax##SUFFIX(int n_board, ROW planes[][N], ROW* candidates){                          \
+        const int n = (N);                                                                              \
+        (void)n_board;                                  /* only read by the generic kernel */           \
+        ROW with_bit[N];                                                                                \
+        for(int p = DENSITY_PLANES - 1; p >= 0; p--){                                                   \
+                ROW any = 0;                                                                            \
+                for(int y = 0; y < n; y++){                                                             \
+                        with_bit[y] = candidates[y] & planes[p][y];                                     \
+                        any |= with_bit[y];                                                             \
+                }                                                                                       \
+                if(any != 0){                                                                           \
+                        for(int y = 0; y < n; y++){                                                     \
+                                candidates[y] = with_bit[y];                                            \
+                        }                                                                               \
+                }                                                                                       \
+        }                                                                                               \
+}                                                                                                       \
+                                                                                                        \
+static void density##SUFFIX(const uint64_t* free_rows, const uint64_t* hit_rows, const uint64_t* unshot_rows, \
+                            const int* sizes, int nb_sizes, int n_board, int* x, int* y){               \
+        const int n = (N);                                                                              \
+        ROW free_cases[N], hits[N], starts[N], covers[N], hit_starts[N], shifted[N];                    \
+        ROW planes[DENSITY_PLANES][N], hit_planes[DENSITY_PLANES][N];                                   \
+        memset(planes,0,sizeof(planes));                                                                \
+        memset(hit_planes,0,sizeof(hit_planes));                                                        \
+        for(int r = 0; r < n; r++){                                                                     \
+                free_cases[r] = (r < n_board) ? (ROW)free_rows[r] : 0;                                  \
+                hits[r] = (r < n_board) ? (ROW)hit_rows[r] : 0;                                         \
+        }                                                                                               \
+        for(int b = 0; b < nb_sizes; b++){                                                              \
+                int size = sizes[b];                                                                    \
+                for(int r = 0; r < n; r++){                     /* horizontal placements, row by row */ \
+                        starts[r] = free_cases[r];                                                      \
+                        covers[r] = hits[r];                                                            \
+                        for(int k = 1; k < size; k++){                                                  \
+                                starts[r] &= free_cases[r] >> k;                                        \
+                                covers[r] |= hits[r] >> k;                                              \
+                        }                                                                               \
+                        hit_starts[r] = starts[r] & covers[r];                                          \
+                }                                                                                       \
+                for(int k = 0; k < size; k++){                                                          \
+                        for(int r = 0; r < n; r++){                                                     \
+                                shifted[r] = (ROW)(starts[r] << k);                                     \
+                        }                                                                               \
+                        densityAdd##SUFFIX(n_board,planes,shifted);                                     \
+                        for(int r = 0; r < n; r++){                                                     \
+                                shifted[r] = (ROW)(hit_starts[r] << k);                                 \
+                        }                                                                               \
+                        densityAdd##SUFFIX(n_board,hit_planes,shifted);                                 \
+                }                                                                                       \
+                if(size == 1){                                  /* both orientations are the same */    \
+                        continue;                                                                       \
+                }                                                                                       \
+                for(int r = 0; r < n; r++){                     /* vertical placements, rows ANDed */   \
+                        starts[r] = (r + size <= n) ? free_cases[r] : 0;                                \
+                        covers[r] = 0;                                                                  \
+                        for(int k = 0; k < size && r + k < n; k++){                                     \
+                                starts[r] &= free_cases[r + k];                                         \
+                                covers[r] |= hits[r + k];                                               \
+                        }                                                                               \
+                        hit_starts[r] = starts[r] & covers[r];                                          \
+                }                                                                                       \
+                for(int k = 0; k < size; k++){                                                          \
+                        for(int r = 0; r < n; r++){                                                     \
+                                shifted[r] = (r >= k) ? starts[r - k] : 0;                              \
+                        }                                                                               \
+                        densityAdd##SUFFIX(n_board,planes,shifted);                                     \
+                        for(int r = 0; r < n; r++){                                                     \
+                                shifted[r] = (r >= k) ? hit_starts[r - k] : 0;                          \
+                        }                                                                               \
+                        densityAdd##SUFFIX(n_board,hit_planes,shifted);                                 \
+                }                                                                                       \
+        }                                                                                               \
+        for(int r = 0; r < n; r++){                                                                     \
+                shifted[r] = (r < n_board) ? (ROW)unshot_rows[r] : 0;                                   \
+        }                                                                                               \
+        densityMax##SUFFIX(n_board,hit_planes,shifted);                                                 \
+        densityMax##SUFFIX(n_board,planes,shifted);                                                     \
+        for(int r = 0; r < n; r++){                             /* first case among the best ones */    \
+                if(shifted[r] != 0){                                                                    \
+                        *x = __builtin_ctzll((unsigned long long)shifted[r]);                           \
+                        *y = r;                                                                         \
+                        return;                                                                         \
+                }                                                                                       \
+        }                                                                                               \
+}
+
+/**
+ * @brief Defines the kernels of a board size.
+ *
+ * @param SUFFIX Suffix of the generated function names.
+ * @param N Size of the board: a constant, or n_board for the generic kernels.
+ * @param DENSITY Density kernel of the size, NULL when the board fits in a bitboard.
+ */
+#define DEFINE_BOARD_KERNELS(SUFFIX, N, DENSITY)                                                        \
+                                                                                                        \
+static void boatPlacement##SUFFIX(Case_type* cells, int* boat_ids, int n_board, Boat* boat_list, int nb){ \
+        const int n = (N);                                                                              \
+        (void)n_board;                                  /* only read by the generic kernel */           \
+        for(int i = 0; i < nb; i++){                                                                    \
+                int step = (boat_list[i].orientation == 0) ? 1 : n;                                     \
+                int first = boat_list[i].y_pos * n + boat_list[i].x_pos;                                \
+                for(int k = 0; k < boat_list[i].boat_size; k++){                                        \
+                        cells[first + k * step] = BOAT;                                                 \
+                        boat_ids[first + k * step] = i;                                                 \
+                }                                                                                       \
+        }                                                                                               \
+}                                                                                                       \
+                                                                                                        \
+static const Board_kernels kernels##SUFFIX = {boatPlacement##SUFFIX, DENSITY};
+
+DEFINE_DENSITY_KERNEL(16, 16, uint16_t)
+DEFINE_DENSITY_KERNEL(Generic, n_board, uint64_t)
+
+DEFINE_BOARD_KERNELS(8, 8, NULL)              //the density bot uses the bitboard kernel of Density.c up to 10x10
+DEFINE_BOARD_KERNELS(10, 10, NULL)
+DEFINE_BOARD_KERNELS(16, 16, density16)
+DEFINE_BOARD_KERNELS(Generic, n_board, densityGeneric)
+
+static const Board_kernels kernelsUpTo16 = {boatPlacementGeneric, density16};   //11x11 to 15x15: the 16-bit density rows, padded
+
+/**
+ * @brief Gives the kernels to use on a board of the given size.
+ *
+ * @param[in] size Size of the game board.
+ * @return The kernels specialized for this size, the density kernel of 16x16 boards for the boards from 11x11 to 15x15,
+ * or the generic ones.
+ */
+const Board_kernels* boardKernels(int size){
+        switch(size){
+                case 8:
+                        return &kernels8;
+                case 10:
+                        return &kernels10;
+                case 16:
+                        return &kernels16;
+                case 11: case 12: case 13: case 14: case 15:
+                        return &kernelsUpTo16;
+                default:
+                        return &kernelsGeneric;
+        }
+}
@@ -0,0 +1,263 @@
+/**
+ * @file MonteCarlo.c
+ * @brief .c file containing the Monte Carlo posterior sampling bot
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The bot draws many full layouts of the remaining enemy boats with the
+ * placement table, keeps those consistent with the board (no boat on a miss or
+ * a sunk boat, every wreck still alive covered) and shoots the case occupied in
+ * the most layouts. Every core samples with its own generator and counters,
+ * which are only added together once the time budget is over. The sampling
+ * threads of a seat are started once with its sampler and wait for the next
+ * decision between two shots.
+ */
+#include "header.h"
+
+/**
+ * @brief Structure representing the work of one sampling thread.
+ */
+typedef struct Mc_worker{
+        Mc_sampler* sampler;                            /**< Sampler the thread belongs to. */
+        Bitmask free;                                   /**< Cases where a remaining boat may be. */
+        Bitmask hits;                                   /**< Wrecks every layout has to cover. */
+        int* sizes;                                     /**< Sizes of the remaining boats, the biggest first. */
+        int nb_sizes;                                   /**< Number of remaining boats. */
+        struct timespec deadline;                       /**< Time at which the sampling stops. */
+        long max_samples;                               /**< Number of consistent layouts at which the sampling stops. */
+        Rng rng;                                        /**< Generator of the thread. */
+        unsigned int counts[2 * 64];                    /**< Number of consistent layouts occupying each bit of the bitboard. */
+        long samples;                                   /**< Number of consistent layouts found. */
+        pthread_t thread;                               /**< Thread of the worker, the first one being the caller of monteCarloTarget. */
+}Mc_worker;
+
+/**
+ * @brief Checks if a deadline is over.
+ *
+ * @param[in] deadline The deadline to check.
+ * @return 1 if the current time is past the deadline, 0 otherwise.
+ */
+static int deadlineOver(struct timespec* deadline){
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC,&now);
+        return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+/**
+ * @brief Samples layouts until the deadline or the sample limit of the worker.
+ *
+ * @param[in,out] arg Pointer to the Mc_worker of the thread.
+ * @return NULL.
+ */
+static void* monteCarloWorker(void* arg){
+        Mc_worker* worker = arg;
+        Placement placement;
+        long tries = 0;
+        while(worker->samples < worker->max_samples){
+                if((tries & 63) == 0 && deadlineOver(&worker->deadline)){  //reading the clock every layout would cost more than sampling
+                        break;
+                }
+                tries++;
+                Bitmask layout = 0;
+                int complete = 1;
+                for(int i = 0; i < worker->nb_sizes && complete; i++){
+                        complete = samplePlacement(worker->sizes[i],layout | ~worker->free,&placement,&worker->rng);
+                        layout |= placement.mask;
+                }
+                if(complete == 0 || (worker->hits & ~layout) != 0){  //the layout doesn't explain the board
+                        continue;
+                }
+                worker->samples++;
+                while(layout != 0){
+                        int cell = bitFirstCell(layout);
+                        worker->counts[cell]++;
+                        layout &= layout - 1;
+                }
+        }
+        return NULL;
+}
+
+/**
+ * @brief Samples for every decision of a sampler, until the sampler is freed.
+ *
+ * @param[in,out] arg Pointer to the Mc_worker of the thread.
+ * @return NULL.
+ */
+static void* monteCarloHelper(void* arg){
+        Mc_worker* worker = arg;
+        Mc_sampler* sampler = worker->sampler;
+        long round = 0;
+        pthread_mutex_lock(&sampler->lock);
+        while(1){
+                while(!sampler->stop && sampler->round == round){      //wait for the next decision
+                        pthread_cond_wait(&sampler->start,&sampler->lock);
+                }
+                if(sampler->stop){
+                        break;
+                }
+                round = sampler->round;
+                pthread_mutex_unlock(&sampler->lock);
+                monteCarloWorker(worker);
+                pthread_mutex_lock(&sampler->lock);
+                if(--sampler->running == 0){
+                        pthread_cond_signal(&sampler->done);
+                }
+        }
+        pthread_mutex_unlock(&sampler->lock);
+        return NULL;
+}
+
+/**
+ * @brief Creates the sampler of a Monte Carlo seat and starts its sampling threads.
+ *
+ * The calling thread of monteCarloTarget samples too, so nb_threads - 1 threads
+ * are started; they sleep between two decisions.
+ *
+ * @param[in] nb_threads Number of sampling threads, one per core if not positive.
+ * @return A pointer to the created sampler.
+ *
+ * @note The function exits with an error message if memory allocation fails or if a thread can't be created.
+ */
+Mc_sampler* monteCarloSamplerCreate(int nb_threads){
+        if(nb_threads < 1){
+                nb_threads = sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        if(nb_threads < 1){
+                nb_threads = 1;
+        }
+        Mc_sampler* sampler = malloc(sizeof(Mc_sampler));
+        Mc_worker* workers = calloc(nb_threads,sizeof(Mc_worker));
+        if(sampler == NULL || workers == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        sampler->nb_threads = nb_threads;
+        sampler->workers = workers;
+        sampler->round = 0;
+        sampler->running = 0;
+        sampler->stop = 0;
+        pthread_mutex_init(&sampler->lock,NULL);
+        pthread_cond_init(&sampler->start,NULL);
+        pthread_cond_init(&sampler->done,NULL);
+        for(int t = 0; t < nb_threads; t++){
+                workers[t].sampler = sampler;
+                if(t > 0 && pthread_create(&workers[t].thread,NULL,monteCarloHelper,&workers[t]) != 0){
+                        fprintf(stderr,"Erreur lors de la création d'un thread");
+                        exit(1);
+                }
+        }
+        return sampler;
+}
+
+/**
+ * @brief Stops the sampling threads of a sampler and frees it.
+ *
+ * @param[in] sampler Pointer to the sampler to be freed.
+ *
+ * @note If the sampler pointer is NULL, nothing is freed.
+ */
+void monteCarloSamplerFree(Mc_sampler* sampler){
+        if(sampler == NULL){
+                return;
+        }
+        pthread_mutex_lock(&sampler->lock);
+        sampler->stop = 1;
+        pthread_cond_broadcast(&sampler->start);
+        pthread_mutex_unlock(&sampler->lock);
+        for(int t = 1; t < sampler->nb_threads; t++){
+                pthread_join(sampler->workers[t].thread,NULL);
+        }
+        pthread_mutex_destroy(&sampler->lock);
+        pthread_cond_destroy(&sampler->start);
+        pthread_cond_destroy(&sampler->done);
+        free(sampler->workers);
+        free(sampler);
+}
+
+/**
+ * @brief Chooses the case targeted by the Monte Carlo bot.
+ *
+ * The sampling threads of the sampler run until the time budget is spent or
+ * MC_MAX_SAMPLES consistent layouts have been found, then the counters are merged
+ * and the unshot case occupied in the most layouts is chosen. If no consistent
+ * layout was found in time, or if the board doesn't fit in a bitboard, the
+ * decision falls back to densityTarget.
+ *
+ * @param[in] board Pointer to the targeted game board structure.
+ * @param[in] boat_list Pointer to the array of the targeted boats.
+ * @param[out] x X-coordinate chosen by the bot.
+ * @param[out] y Y-coordinate chosen by the bot.
+ * @param[in] budget_ms Time budget of the decision, in milliseconds.
+ * @param[in,out] sampler Pointer to the sampler of the seat, used by one decision at a time.
+ * @param[in,out] rng Pointer to the random generator the threads are seeded from.
+ *
+ * @note The function exits with an error message if a pointer is NULL.
+ */
+void monteCarloTarget(Game_board* board, Boat* boat_list, int* x, int* y, double budget_ms, Mc_sampler* sampler, Rng* rng){
+        if (board == NULL || boat_list == NULL || x == NULL || y == NULL || sampler == NULL || rng == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        if(!bitBoardFits(board->Matrix_size)){
+                densityTarget(board,boat_list,x,y,rng);
+                return;
+        }
+        placementTableInit();                                   //built before the threads read it
+        int nb_threads = sampler->nb_threads;
+        Mc_worker* workers = sampler->workers;
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC,&deadline);
+        long budget_ns = (long)(budget_ms * 1e6);
+        deadline.tv_sec += (deadline.tv_nsec + budget_ns) / 1000000000L;
+        deadline.tv_nsec = (deadline.tv_nsec + budget_ns) % 1000000000L;
+
+        int sizes[game_config.boat_nb];
+        Bitmask free_cases, hits;
+        int nb_sizes = boardObservation(board,boat_list,&free_cases,&hits,sizes);
+        for(int t = 0; t < nb_threads; t++){
+                workers[t].free = free_cases;
+                workers[t].hits = hits;
+                workers[t].sizes = sizes;                       //only read by the threads
+                workers[t].nb_sizes = nb_sizes;
+                workers[t].deadline = deadline;
+                workers[t].max_samples = (MC_MAX_SAMPLES + nb_threads - 1) / nb_threads;
+                rngSplit(rng,&workers[t].rng);
+                memset(workers[t].counts,0,sizeof(workers[t].counts));
+                workers[t].samples = 0;
+        }
+        pthread_mutex_lock(&sampler->lock);                     //wake the threads of the sampler up
+        sampler->round++;
+        sampler->running = nb_threads - 1;
+        pthread_cond_broadcast(&sampler->start);
+        pthread_mutex_unlock(&sampler->lock);
+        monteCarloWorker(&workers[0]);                          //the calling thread samples too
+        pthread_mutex_lock(&sampler->lock);
+        while(sampler->running > 0){
+                pthread_cond_wait(&sampler->done,&sampler->lock);
+        }
+        pthread_mutex_unlock(&sampler->lock);
+        long samples = workers[0].samples;
+        for(int t = 1; t < nb_threads; t++){                   //merge the counters of every thread
+                samples += workers[t].samples;
+                for(int cell = 0; cell < 2 * 64; cell++){
+                        workers[0].counts[cell] += workers[t].counts[cell];
+                }
+        }
+
+        if(samples == 0){
+                densityTarget(board,boat_list,x,y,rng);
+        }
+        else{
+                Bitmask candidates = bitInsideMask(board->Matrix_size) & ~board->bits.shots;
+                int best = bitFirstCell(candidates);
+                while(candidates != 0){
+                        int cell = bitFirstCell(candidates);
+                        if(workers[0].counts[cell] > workers[0].counts[best]){
+                                best = cell;
+                        }
+                        candidates &= candidates - 1;
+                }
+                *x = best % BITBOARD_STRIDE;
+                *y = best / BITBOARD_STRIDE;
+        }
+}
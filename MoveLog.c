@@ -0,0 +1,387 @@
+/**
+ * @file MoveLog.c
+ * @brief .c file containing the append-only move log and its replay reader
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * With --log <file>, every game records its seed when it is created and every
+ * shot at one of its boards as a 16-byte Move_record. The records are kept in a
+ * buffer of the thread playing the game and appended to the file MOVE_LOG_BUFFER
+ * at a time, with one write in append mode, so logging costs a test and a few
+ * stores per shot and the threads never wait for each other.
+ *
+ * The records of the games played at the same time by different threads are
+ * mixed in the file, each one carrying the number of its game. Numbers start
+ * again at 0 with every run appended to the same file, so a MOVE_START record
+ * always begins a new game for its number. The fleets aren't logged: a game is
+ * rebuilt by creating it again from its seed and replaying its shots.
+ *
+ * The reader maps the file in memory and walks the records in place.
+ */
+#include "header.h"
+
+#define MOVE_LOG_MAGIC "BNLG"   /**< First bytes of a move log. */
+#define MOVE_LOG_VERSION 1      /**< Version of the layout of the records. */
+
+_Static_assert(sizeof(Move_record) == 16, "the records of the move log are 16 bytes long");
+
+/**
+ * @brief Structure representing the header of a move log file.
+ */
+typedef struct{
+        char magic[4];        /**< MOVE_LOG_MAGIC. */
+        uint32_t version;     /**< MOVE_LOG_VERSION. */
+        uint32_t record_size; /**< sizeof(Move_record). */
+        uint32_t plate_size;  /**< Size of the game boards. */
+        uint32_t boat_nb;     /**< Number of boats of each fleet. */
+        uint32_t fleet_hash;  /**< Hash of the sizes of the boats of the fleet. */
+        uint32_t reserved[2]; /**< Zero. */
+}Move_log_header;
+
+static __thread Move_record buffer[MOVE_LOG_BUFFER];    /**< Records of the thread not written yet. */
+static __thread int buffered = 0;                       /**< Number of records in the buffer of the thread. */
+
+/**
+ * @brief Builds the header matching the current configuration.
+ *
+ * @param[out] header The header.
+ */
+static void moveLogHeader(Move_log_header* header){
+        memset(header,0,sizeof(*header));
+        memcpy(header->magic,MOVE_LOG_MAGIC,4);
+        header->version = MOVE_LOG_VERSION;
+        header->record_size = sizeof(Move_record);
+        header->plate_size = game_config.plate_size;
+        header->boat_nb = game_config.boat_nb;
+        uint32_t hash = 2166136261u;                            //FNV-1a of the boat sizes
+        for(int i = 0; i < game_config.boat_nb; i++){
+                hash = (hash ^ (uint32_t)game_config.boat_sizes[i]) * 16777619u;
+        }
+        if(game_config.margin > 0){                             //the fleets of the games depend on the margin too
+                hash = (hash ^ (0x80000000u | (uint32_t)game_config.margin)) * 16777619u;
+        }
+        header->fleet_hash = hash;
+}
+
+/**
+ * @brief Checks that the header of a log matches the current configuration.
+ *
+ * @param[in] header The header read in the file.
+ *
+ * @note The function exits with an error message if the header doesn't match.
+ */
+static void moveLogCheck(const Move_log_header* header){
+        Move_log_header expected;
+        moveLogHeader(&expected);
+        if(memcmp(header->magic,MOVE_LOG_MAGIC,4) != 0 || header->record_size != sizeof(Move_record)){
+                fprintf(stderr,"Ce fichier n'est pas un journal de coups");
+                exit(5);
+        }
+        if(header->version != MOVE_LOG_VERSION){
+                fprintf(stderr,"Version de journal non supportée: %u",header->version);
+                exit(5);
+        }
+        if(memcmp(header,&expected,sizeof(expected)) != 0){
+                fprintf(stderr,"Le journal a été écrit avec un autre plateau ou une autre flotte");
+                exit(5);
+        }
+}
+
+/**
+ * @brief Appends the records of the calling thread to the log.
+ *
+ * Every thread playing logged games must call it once it is done, the main
+ * thread's records being written by moveLogClose.
+ *
+ * @param[in,out] log Pointer to the log, nothing is done if NULL.
+ *
+ * @note The function exits with an error message if the log can't be written.
+ */
+void moveLogFlush(Move_log* log){
+        if(log == NULL || buffered == 0){
+                return;
+        }
+        size_t length = buffered * sizeof(Move_record);
+        if(write(log->fd,buffer,length) != (ssize_t)length){     //one append, never mixed with the writes of other threads
+                fprintf(stderr,"Erreur d'écriture dans le journal");
+                exit(5);
+        }
+        buffered = 0;
+}
+
+/**
+ * @brief Adds a record to the buffer of the calling thread.
+ *
+ * @param[in,out] log Pointer to the log.
+ * @param[in] record The record.
+ */
+static void moveLogAppend(Move_log* log, const Move_record* record){
+        buffer[buffered++] = *record;
+        if(buffered == MOVE_LOG_BUFFER){
+                moveLogFlush(log);
+        }
+}
+
+/**
+ * @brief Opens a move log, creating it if needed.
+ *
+ * The records are appended after those already in the file, which must have
+ * been written with the same board size and fleet.
+ *
+ * @param[in] path Path of the log.
+ * @return A pointer to the opened log.
+ *
+ * @note The function exits with an error message if the file can't be opened or doesn't match the configuration,
+ * or if memory allocation fails.
+ */
+Move_log* moveLogOpen(const char* path){
+        if(path == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Move_log* log = malloc(sizeof(Move_log));
+        if(log == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        log->fd = open(path,O_RDWR | O_CREAT | O_APPEND,0644);
+        if(log->fd < 0){
+                fprintf(stderr,"Impossible d'ouvrir %s",path);
+                exit(5);
+        }
+        log->next_game = 0;
+        Move_log_header header;
+        ssize_t nb = pread(log->fd,&header,sizeof(header),0);
+        if(nb == 0){                                            //new log
+                moveLogHeader(&header);
+                if(write(log->fd,&header,sizeof(header)) != sizeof(header)){
+                        fprintf(stderr,"Erreur d'écriture dans le journal");
+                        exit(5);
+                }
+        }
+        else if(nb != sizeof(header)){
+                fprintf(stderr,"Ce fichier n'est pas un journal de coups");
+                exit(5);
+        }
+        else{
+                moveLogCheck(&header);
+        }
+        return log;
+}
+
+/**
+ * @brief Starts logging a game: records its seed and attaches the log to its boards.
+ *
+ * @param[in,out] log Pointer to the log.
+ * @param[in,out] game Pointer to the game, just created from the seed.
+ * @param[in] seed Seed the game was created with.
+ *
+ * @note The function exits with an error message if a pointer is NULL.
+ */
+void moveLogGame(Move_log* log, Game* game, uint64_t seed){
+        if(log == NULL || game == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Move_record record;
+        memset(&record,0,sizeof(record));
+        record.game = __atomic_fetch_add(&log->next_game,1,__ATOMIC_RELAXED);
+        record.kind = MOVE_START;
+        record.boat = MOVE_NO_BOAT;
+        record.seed = seed;
+        moveLogAppend(log,&record);
+        game->tab_bot->log = log;                               //seat 0 shoots at the bot board
+        game->tab_bot->log_game = record.game;
+        game->tab_bot->log_seat = 0;
+        game->tab_player->log = log;
+        game->tab_player->log_game = record.game;
+        game->tab_player->log_seat = 1;
+}
+
+/**
+ * @brief Records a shot at a logged board.
+ *
+ * @param[in] board Pointer to the targeted game board structure, board->log must not be NULL.
+ * @param[in] x X-coordinate of the shot.
+ * @param[in] y Y-coordinate of the shot.
+ * @param[in] result Result of the shot.
+ * @param[in] boat_id Index of the boat hit, -1 if none.
+ */
+void moveLogShot(Game_board* board, int x, int y, Shot_result result, int boat_id){
+        Move_record record;
+        record.game = board->log_game;
+        record.kind = result;
+        record.seat = board->log_seat;
+        record.boat = (boat_id < 0) ? MOVE_NO_BOAT : boat_id;
+        record.seed = 0;
+        record.shot.x = x;
+        record.shot.y = y;
+        moveLogAppend(board->log,&record);
+}
+
+/**
+ * @brief Writes the records of the calling thread and closes a log.
+ *
+ * @param[in] log Pointer to the log to be closed.
+ *
+ * @note If the log pointer is NULL, nothing is done.
+ */
+void moveLogClose(Move_log* log){
+        if(log == NULL){
+                return;
+        }
+        moveLogFlush(log);
+        close(log->fd);
+        free(log);
+}
+
+/**
+ * @brief Rebuilds one game of a log, checks its shots and displays its final boards.
+ *
+ * @param[in] records The records of the log.
+ * @param[in] nb Number of records.
+ * @param[in] start Index of the MOVE_START record of the game.
+ *
+ * @note The function exits with an error message if a shot doesn't give the logged result.
+ */
+static void replayLoggedGame(const Move_record* records, size_t nb, size_t start){
+        uint32_t number = records[start].game;
+        Game* game = createGame(records[start].seed);
+        gameBoardInit(game->tab_bot);
+        gameBoardInit(game->tab_player);
+        boatPlacement(game->tab_bot,game->boat_tab_bot);
+        boatPlacement(game->tab_player,game->boat_tab_player);
+        Game_board* targets[2] = {game->tab_bot, game->tab_player};
+        int shots[2] = {0, 0};
+        for(size_t i = start + 1; i < nb; i++){
+                const Move_record* record = &records[i];
+                if(record->game != number){                     //record of another game played at the same time
+                        continue;
+                }
+                if(record->kind == MOVE_START){                 //the number was given again by a later run
+                        break;
+                }
+                int boat_id = -1;
+                Shot_result result = resolveShot(targets[record->seat],record->shot.x,record->shot.y,&boat_id);
+                if(result != record->kind || (boat_id < 0 ? MOVE_NO_BOAT : boat_id) != record->boat){
+                        fprintf(stderr,"Journal incohérent au coup %d du siège %d",shots[record->seat] + 1,record->seat);
+                        exit(5);
+                }
+                shots[record->seat]++;
+        }
+        Game_board* boards[2] = {game->tab_player, game->tab_bot};
+        const int hidden[2] = {0, 0};
+        const char* titles[2] = {" --- JOUEUR ---", " --- BOT ---"};
+        game->renderer = rendererCreate(game_config.plate_size,0);
+        renderBoards(game->renderer,boards,hidden,titles);
+        printf("Partie de la graine %llu: %d tirs du joueur, %d tirs du bot, ",(unsigned long long)records[start].seed,shots[0],shots[1]);
+        if(fleetDestroyed(game->tab_bot)){
+                printf("victoire du joueur\n");
+        }
+        else if(fleetDestroyed(game->tab_player)){
+                printf("victoire du bot\n");
+        }
+        else{
+                printf("partie inachevée\n");
+        }
+        freeGame(game);
+}
+
+/**
+ * @brief Reads a move log: displays statistics on every game or rebuilds one of them.
+ *
+ * The log is mapped in memory and read in place. Without a game number, the
+ * function displays the number of games, of finished games and of shots, the
+ * win rate of each seat and the average number of shots. With a game number n,
+ * it rebuilds the n-th game started in the log from its seed, checks every
+ * logged shot against the rules and displays the final boards.
+ *
+ * @param[in] path Path of the log.
+ * @param[in] game_number Number of the game to rebuild, counted from 0 in the order the games started, or -1 for the statistics.
+ *
+ * @note The function exits with an error message if the log can't be read or doesn't match the configuration,
+ * if the game doesn't exist, or if memory allocation fails.
+ */
+void runReplay(const char* path, long game_number){
+        if(path == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        if(game_config.log != NULL){
+                fprintf(stderr,"--log ne peut pas être utilisé pour relire un journal");
+                exit(2);
+        }
+        int fd = open(path,O_RDONLY);
+        struct stat info;
+        if(fd < 0 || fstat(fd,&info) != 0){
+                fprintf(stderr,"Impossible d'ouvrir %s",path);
+                exit(5);
+        }
+        if((size_t)info.st_size < sizeof(Move_log_header) || (info.st_size - sizeof(Move_log_header)) % sizeof(Move_record) != 0){
+                fprintf(stderr,"Ce fichier n'est pas un journal de coups");
+                exit(5);
+        }
+        const char* data = mmap(NULL,info.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+        if(data == MAP_FAILED){
+                fprintf(stderr,"Impossible de lire %s",path);
+                exit(5);
+        }
+        moveLogCheck((const Move_log_header*)data);
+        const Move_record* records = (const Move_record*)(data + sizeof(Move_log_header));
+        size_t nb = (info.st_size - sizeof(Move_log_header)) / sizeof(Move_record);
+
+        if(game_number >= 0){
+                long started = 0;
+                size_t i = 0;
+                for(; i < nb; i++){
+                        if(records[i].kind == MOVE_START && started++ == game_number){
+                                break;
+                        }
+                }
+                if(i == nb){
+                        fprintf(stderr,"Le journal ne contient que %ld parties",started);
+                        exit(2);
+                }
+                replayLoggedGame(records,nb,i);
+        }
+        else{
+                uint32_t max_number = 0;
+                for(size_t i = 0; i < nb; i++){
+                        if(records[i].game > max_number){
+                                max_number = records[i].game;
+                        }
+                }
+                int* sunk = calloc(2 * ((size_t)max_number + 1),sizeof(int));  //boats sunk by each seat in the current game of each number
+                if(sunk == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                long games = 0, shots = 0, hits = 0, wins[2] = {0, 0};
+                for(size_t i = 0; i < nb; i++){
+                        const Move_record* record = &records[i];
+                        int* game_sunk = sunk + 2 * (size_t)record->game;
+                        if(record->kind == MOVE_START){
+                                games++;
+                                game_sunk[0] = 0;
+                                game_sunk[1] = 0;
+                                continue;
+                        }
+                        shots++;
+                        hits += (record->kind == SHOT_HIT || record->kind == SHOT_SUNK);
+                        if(record->kind == SHOT_SUNK && ++game_sunk[record->seat] == game_config.boat_nb){
+                                wins[record->seat]++;
+                        }
+                }
+                long finished = wins[0] + wins[1];
+                printf("%zu enregistrements, %ld parties dont %ld terminées, %ld tirs (%.2f%% touchés)\n",nb,games,finished,shots,shots ? 100.0 * hits / shots : 0.0);
+                if(finished > 0){
+                        printf("Victoires: joueur %ld (%.2f%%) - bot %ld (%.2f%%)\n",wins[0],100.0 * wins[0] / finished,wins[1],100.0 * wins[1] / finished);
+                }
+                if(games > 0){
+                        printf("Tirs moyens par partie: %.2f\n",(double)shots / games);
+                }
+                free(sunk);
+        }
+        munmap((void*)data,info.st_size);
+        close(fd);
+}
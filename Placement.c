@@ -0,0 +1,165 @@
+/**
+ * @file Placement.c
+ * @brief .c file containing the precomputed table of legal boat placements
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * Every legal (size, x, y, orientation) placement of a boat is computed once
+ * with its bitboard mask. A fleet is then generated by keeping, for each boat,
+ * only the placements that don't intersect the cases already occupied and
+ * drawing one of them, so no boat is ever created and thrown away.
+ */
+#include "header.h"
+
+static Placement* table[BITBOARD_STRIDE];      /**< Legal placements of each boat size, indexed by boat_size - 1. */
+static int table_nb[BITBOARD_STRIDE];           /**< Number of legal placements of each boat size. */
+static int* fleet_order = NULL;                 /**< Indexes of the boats of the fleet, the biggest first. */
+static int table_ready = 0;                     /**< 1 once the table has been computed. */
+
+/**
+ * @brief Computes the table of every legal placement of every boat size of the fleet.
+ *
+ * The function enumerates, for each boat size up to the biggest boat of the
+ * configuration, every position and orientation keeping the boat inside the
+ * board and stores it with its mask. A boat of size 1 is only stored once since
+ * both orientations cover the same case. It also sorts the boats of the fleet
+ * from the biggest to the smallest. Calling it again does nothing; it must be
+ * called once before the table is read from several threads.
+ *
+ * @note The function exits with an error message if the board doesn't fit in a bitboard or if memory allocation fails.
+ */
+void placementTableInit(){
+        if(table_ready == 1){
+                return;
+        }
+        int plate = game_config.plate_size;
+        if(!bitBoardFits(plate)){
+                fprintf(stderr,"Plateau trop grand pour la table de placements");
+                exit(2);
+        }
+        for(int size = 1; size <= game_config.max_boat_size; size++){
+                Placement* list = malloc(2 * plate * plate * sizeof(Placement));
+                if(list == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                int nb = 0;
+                for(int orientation = 0; orientation < (size == 1 ? 1 : 2); orientation++){
+                        int max_x = (orientation == 0) ? plate - size : plate - 1;     //the boat must stay inside the board
+                        int max_y = (orientation == 1) ? plate - size : plate - 1;
+                        for(int y = 0; y <= max_y; y++){
+                                for(int x = 0; x <= max_x; x++){
+                                        list[nb].boat.boat_size = size;
+                                        list[nb].boat.x_pos = x;
+                                        list[nb].boat.y_pos = y;
+                                        list[nb].boat.orientation = orientation;
+                                        list[nb].mask = boatMask(&list[nb].boat);
+                                        nb++;
+                                }
+                        }
+                }
+                table[size - 1] = list;
+                table_nb[size - 1] = nb;
+        }
+        fleet_order = malloc(game_config.boat_nb * sizeof(int));
+        if(fleet_order == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        for(int i = 0; i < game_config.boat_nb; i++){          //insertion sort, the biggest boats first
+                int j = i;
+                while(j > 0 && game_config.boat_sizes[fleet_order[j - 1]] < game_config.boat_sizes[i]){
+                        fleet_order[j] = fleet_order[j - 1];
+                        j--;
+                }
+                fleet_order[j] = i;
+        }
+        table_ready = 1;
+}
+
+/**
+ * @brief Gives access to the legal placements of a boat.
+ *
+ * @param[in] boat_size Size of the boat.
+ * @param[out] nb Number of placements in the returned array.
+ * @return The array of every legal placement of a boat of this size.
+ *
+ * @note The function exits with an error message if the size is invalid.
+ */
+Placement* placementList(int boat_size, int* nb){
+        if(boat_size < 1 || boat_size > game_config.max_boat_size || nb == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        placementTableInit();
+        *nb = table_nb[boat_size - 1];
+        return table[boat_size - 1];
+}
+
+/**
+ * @brief Draws a random placement of a boat among those that don't intersect the occupied cases.
+ *
+ * The legal placements are filtered against the occupied mask and one of the
+ * remaining ones is drawn uniformly.
+ *
+ * @param[in] boat_size Size of the boat.
+ * @param[in] occupied Mask of the cases the boat can't cover.
+ * @param[out] placement The drawn placement.
+ * @param[in,out] rng Pointer to the random generator to draw with.
+ * @return 1 if a placement was drawn, 0 if no placement is free.
+ */
+int samplePlacement(int boat_size, Bitmask occupied, Placement* placement, Rng* rng){
+        int nb;
+        Placement* list = placementList(boat_size,&nb);
+        int free_list[2 * BITBOARD_STRIDE * BITBOARD_STRIDE];
+        int nb_free = 0;
+        for(int i = 0; i < nb; i++){                          //keep only the placements on free cases
+                free_list[nb_free] = i;
+                nb_free += (list[i].mask & occupied) == 0;
+        }
+        if(nb_free == 0){
+                return 0;
+        }
+        *placement = list[free_list[rngBounded(rng,nb_free)]];
+        return 1;
+}
+
+/**
+ * @brief Generates a whole fleet without collisions from the placement table.
+ *
+ * The boats are placed from the biggest to the smallest, each one drawn among the
+ * placements left free by the previous ones and their no-touch margin. In the rare case where a boat has
+ * no free placement left, the fleet is drawn again.
+ *
+ * @param[out] boat_list Array of the boats of the fleet to fill, boat i having the i-th size of the configuration.
+ * @param[in,out] rng Pointer to the random generator to draw with.
+ * @return The number of times the fleet was drawn again.
+ *
+ * @note The function exits with an error message if a pointer is NULL.
+ */
+int placeFleet(Boat* boat_list, Rng* rng){
+        if(boat_list == NULL || rng == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        placementTableInit();
+        Placement placement;
+        Bitmask occupied = 0;
+        int restarts = 0;
+        for(int k = 0; k < game_config.boat_nb; k++){
+                int i = fleet_order[k];
+                if(samplePlacement(game_config.boat_sizes[i],occupied,&placement,rng) == 0){  //dead end, the fleet is drawn again
+                        occupied = 0;
+                        k = -1;
+                        restarts++;
+                        continue;
+                }
+                boat_list[i] = placement.boat;
+                Bitmask taken = placement.mask;
+                for(int m = 0; m < game_config.margin; m++){           //no-touch margin around the boat
+                        taken = bitGrow(taken,game_config.plate_size);
+                }
+                occupied |= taken;
+        }
+        return restarts;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file Pool.c
+ * @brief .c file containing the work-stealing thread pool
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * Every worker owns a queue of tasks. It takes its own tasks from the end of
+ * its queue and, once it is empty, steals the oldest task of another worker,
+ * so no thread stays idle while work remains anywhere. Each queue has its own
+ * lock, which is only contended when a worker steals.
+ */
+#include "header.h"
+
+/**
+ * @brief Structure representing the argument of a worker thread.
+ */
+typedef struct{
+        Thread_pool* pool;    /**< The pool the worker belongs to. */
+        int index;            /**< Index of the queue owned by the worker. */
+}Pool_worker;
+
+/**
+ * @brief Creates a thread pool with one empty queue per worker.
+ *
+ * @param[in] nb_workers Number of workers, one per core if not positive.
+ * @return A pointer to the created pool.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+Thread_pool* poolCreate(int nb_workers){
+        if(nb_workers < 1){
+                nb_workers = sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        if(nb_workers < 1){
+                nb_workers = 1;
+        }
+        Thread_pool* pool = malloc(sizeof(Thread_pool));
+        if(pool == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        pool->nb_workers = nb_workers;
+        pool->next_queue = 0;
+        pool->queues = calloc(nb_workers,sizeof(Work_queue));
+        if(pool->queues == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        for(int i = 0; i < nb_workers; i++){
+                pthread_mutex_init(&pool->queues[i].lock,NULL);
+        }
+        return pool;
+}
+
+/**
+ * @brief Adds a task to the pool.
+ *
+ * The tasks are dealt to the queues in turn. Every task must be submitted before
+ * poolRun is called.
+ *
+ * @param[in,out] pool Pointer to the pool.
+ * @param[in] function Function executed by the task.
+ * @param[in] arg Argument given to the function.
+ *
+ * @note The function exits with an error message if a parameter is NULL or if memory allocation fails.
+ */
+void poolSubmit(Thread_pool* pool, Task_function function, void* arg){
+        if(pool == NULL || function == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Work_queue* queue = &pool->queues[pool->next_queue];
+        pool->next_queue = (pool->next_queue + 1) % pool->nb_workers;
+        if(queue->tail == queue->capacity){                   //double the capacity of a full queue
+                queue->capacity = (queue->capacity == 0) ? 16 : 2 * queue->capacity;
+                queue->tasks = realloc(queue->tasks,queue->capacity * sizeof(Task));
+                if(queue->tasks == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+        }
+        queue->tasks[queue->tail].function = function;
+        queue->tasks[queue->tail].arg = arg;
+        queue->tail++;
+}
+
+/**
+ * @brief Takes a task from a queue.
+ *
+ * @param[in,out] queue Pointer to the queue.
+ * @param[in] steal 1 to take the oldest task (stealing), 0 to take the newest one (owner).
+ * @param[out] task The task taken.
+ * @return 1 if a task was taken, 0 if the queue is empty.
+ */
+static int queueTake(Work_queue* queue, int steal, Task* task){
+        int taken = 0;
+        pthread_mutex_lock(&queue->lock);
+        if(queue->head < queue->tail){
+                if(steal){
+                        *task = queue->tasks[queue->head];
+                        queue->head++;
+                }
+                else{
+                        queue->tail--;
+                        *task = queue->tasks[queue->tail];
+                }
+                taken = 1;
+        }
+        pthread_mutex_unlock(&queue->lock);
+        return taken;
+}
+
+/**
+ * @brief Runs the tasks of a worker, then steals from the others until every queue is empty.
+ *
+ * @param[in] arg Pointer to the Pool_worker of the thread.
+ * @return NULL.
+ */
+static void* poolWorker(void* arg){
+        Pool_worker* worker = arg;
+        Thread_pool* pool = worker->pool;
+        Task task;
+        while(1){
+                int found = queueTake(&pool->queues[worker->index],0,&task);
+                for(int i = 1; i < pool->nb_workers && found == 0; i++){        //own queue empty: steal from the next workers
+                        found = queueTake(&pool->queues[(worker->index + i) % pool->nb_workers],1,&task);
+                }
+                if(found == 0){                                  //no task is submitted while running, so the work is over
+                        break;
+                }
+                task.function(task.arg);
+        }
+        return NULL;
+}
+
+/**
+ * @brief Executes every submitted task and returns once they are all done.
+ *
+ * The calling thread works as the first worker, the others run on new threads.
+ *
+ * @param[in,out] pool Pointer to the pool.
+ *
+ * @note The function exits with an error message if the pool is NULL or if a thread can't be created.
+ */
+void poolRun(Thread_pool* pool){
+        if(pool == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        pthread_t* threads = malloc(pool->nb_workers * sizeof(pthread_t));
+        Pool_worker* workers = malloc(pool->nb_workers * sizeof(Pool_worker));
+        if(threads == NULL || workers == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        for(int i = 0; i < pool->nb_workers; i++){
+                workers[i].pool = pool;
+                workers[i].index = i;
+                if(i > 0 && pthread_create(&threads[i],NULL,poolWorker,&workers[i]) != 0){
+                        fprintf(stderr,"Erreur lors de la création d'un thread");
+                        exit(1);
+                }
+        }
+        poolWorker(&workers[0]);
+        for(int i = 1; i < pool->nb_workers; i++){
+                pthread_join(threads[i],NULL);
+        }
+        for(int i = 0; i < pool->nb_workers; i++){            //the queues can be filled again
+                pool->queues[i].head = 0;
+                pool->queues[i].tail = 0;
+        }
+        free(threads);
+        free(workers);
+}
+
+/**
+ * @brief Frees the memory allocated for a thread pool.
+ *
+ * @param[in] pool Pointer to the pool to be freed.
+ *
+ * @note If the pool pointer is NULL, nothing is freed.
+ */
+void poolFree(Thread_pool* pool){
+        if(pool == NULL){
+                return;
+        }
+        for(int i = 0; i < pool->nb_workers; i++){
+                pthread_mutex_destroy(&pool->queues[i].lock);
+                free(pool->queues[i].tasks);
+        }
+        free(pool->queues);
+        free(pool);
+}
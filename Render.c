@@ -0,0 +1,347 @@
+/**
+ * @file Render.c
+ * @brief .c file containing the frame-buffered renderer of the game boards
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * A frame shows both boards side by side. It is formatted into a buffer
+ * allocated once for the size of the board and sent to the terminal with a
+ * single write, instead of one printf per case. In ANSI mode the first frame
+ * clears the screen and is drawn at the top of it; the next frames only move the
+ * cursor to the cases whose symbol changed since the previous frame and redraw
+ * those, so the screen no longer scrolls on every shot.
+ */
+#include "header.h"
+
+#define RENDER_GAP 6          /**< Spaces between the two boards of a frame. */
+#define RENDER_TITLE_WIDTH 28 /**< Minimum width of the column of a board, so its title fits. */
+
+/**
+ * @brief Gives the number of digits of the biggest coordinate of a board.
+ *
+ * @param[in] size Size of the game board.
+ * @return The number of digits of size - 1.
+ */
+static int renderDigits(int size){
+        int digits = 1;
+        for(int max = size - 1; max >= 10; max /= 10){
+                digits++;
+        }
+        return digits;
+}
+
+/**
+ * @brief Gives the symbol displayed for a case.
+ *
+ * @param[in] type Type of the case.
+ * @param[in] hidden 1 if the boats of the board must stay hidden (enemy board).
+ * @return '~' for water, 'X' for a shot in the water, 'O' for a boat and 'D' for a wreck.
+ */
+static char caseSymbol(Case_type type, int hidden){
+        switch(type){
+                case WATER_SHOT:
+                        return 'X';
+                case WRECK:
+                        return 'D';
+                case BOAT:
+                        return hidden ? '~' : 'O';
+                default:
+                        return '~';
+        }
+}
+
+/**
+ * @brief Gives the width of a row label, as in "0  " or "07   ".
+ *
+ * @param[in] digits Number of digits of the coordinates.
+ * @return The width of the label.
+ */
+static int labelWidth(int digits){
+        return (digits == 1) ? digits + 2 : digits + 3;
+}
+
+/**
+ * @brief Gives the width of the column of a board in a frame.
+ *
+ * @param[in] size Size of the game board.
+ * @return The width of the column.
+ */
+static int columnWidth(int size){
+        int digits = renderDigits(size);
+        int width = labelWidth(digits) + size * (digits + 1);
+        return (width < RENDER_TITLE_WIDTH) ? RENDER_TITLE_WIDTH : width;
+}
+
+/**
+ * @brief Pads a line of a board with spaces up to the width of its column.
+ *
+ * @param[out] out Where the spaces are written.
+ * @param[in] written Characters already written in the column.
+ * @param[in] width Width of the column.
+ * @return The number of spaces written.
+ */
+static size_t renderPad(char* out, size_t written, int width){
+        size_t nb = (written < (size_t)width) ? width - written : 0;
+        memset(out,' ',nb);
+        return nb;
+}
+
+/**
+ * @brief Formats the line of column numbers of a board.
+ *
+ * @param[out] out Where the line is written, without its end of line.
+ * @param[in] size Size of the game board.
+ * @return The number of characters written.
+ */
+static size_t renderHeader(char* out, int size){
+        int digits = renderDigits(size);
+        size_t length = renderPad(out,0,labelWidth(digits));
+        for(int k = 0; k < size; k++){
+                length += snprintf(out + length,digits + 2,"%0*d ",digits,k);           //the number, its space and the end of string
+        }
+        return length;
+}
+
+/**
+ * @brief Formats a row of a board: its number followed by the symbol of each case.
+ *
+ * @param[out] out Where the row is written, without its end of line.
+ * @param[in] board Pointer to the game board structure.
+ * @param[in] row Number of the row.
+ * @param[in] hidden 1 if the boats of the board must stay hidden.
+ * @return The number of characters written.
+ */
+static size_t renderRow(char* out, Game_board* board, int row, int hidden){
+        int digits = renderDigits(board->Matrix_size);
+        size_t length = sprintf(out,"%0*d",digits,row);
+        length += renderPad(out + length,length,labelWidth(digits));
+        const Case_type* cells = board->cells + (size_t)row * board->Matrix_size;
+        memset(out + length,' ',(size_t)board->Matrix_size * (digits + 1));
+        for(int j = 0; j < board->Matrix_size; j++){
+                out[length + (size_t)j * (digits + 1)] = caseSymbol(cells[j],hidden);
+        }
+        return length + (size_t)board->Matrix_size * (digits + 1);
+}
+
+/**
+ * @brief Formats the symbols of a board, one line per row, without coordinates.
+ *
+ * @param[out] out Where the rows are written, room for Matrix_size * (Matrix_size + 1) characters.
+ * @param[in] board Pointer to the game board structure.
+ * @param[in] hidden 1 if the boats of the board must stay hidden.
+ * @return The number of characters written.
+ */
+size_t renderSymbols(char* out, Game_board* board, int hidden){
+        size_t length = 0;
+        for(size_t i = 0; i < (size_t)board->Matrix_size * board->Matrix_size; i++){
+                out[length++] = caseSymbol(board->cells[i],hidden);
+                if((i + 1) % board->Matrix_size == 0){
+                        out[length++] = '\n';
+                }
+        }
+        return length;
+}
+
+/**
+ * @brief Writes a buffer on the standard output in one go.
+ *
+ * The messages still waiting in the stdio buffer are flushed first so the frame
+ * comes after them.
+ *
+ * @param[in] buffer The characters to write.
+ * @param[in] length Number of characters.
+ */
+static void renderWrite(const char* buffer, size_t length){
+        fflush(stdout);
+        while(length > 0){
+                ssize_t written = write(STDOUT_FILENO,buffer,length);
+                if(written <= 0){
+                        return;
+                }
+                buffer += written;
+                length -= written;
+        }
+}
+
+/**
+ * @brief Creates a renderer for boards of the given size.
+ *
+ * @param[in] size Size of the game boards.
+ * @param[in] ansi 1 to redraw only the cases that changed with ANSI escape sequences, 0 to draw full frames.
+ * @return A pointer to the created renderer.
+ *
+ * @note The function exits with an error message if the size is invalid or if memory allocation fails.
+ */
+Renderer* rendererCreate(int size, int ansi){
+        if(size < 1){
+                fprintf(stderr,"taille incorrecte");
+                exit(1);
+        }
+        Renderer* renderer = malloc(sizeof(Renderer));
+        if(renderer == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        size_t line = 2 * (size_t)columnWidth(size) + RENDER_GAP + 1;
+        renderer->capacity = (size + 3) * line + 64;                            //titles, numbers, rows and a blank line
+        renderer->buffer = malloc(renderer->capacity + 2 * (size_t)size * size);
+        if(renderer->buffer == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        renderer->previous = renderer->buffer + renderer->capacity;
+        renderer->size = size;
+        renderer->ansi = ansi;
+        renderer->drawn = 0;
+        return renderer;
+}
+
+/**
+ * @brief Draws two boards side by side.
+ *
+ * The first frame, and every frame outside ANSI mode, is drawn in full. In ANSI
+ * mode the next frames only redraw the cases whose symbol changed, then put the
+ * cursor back under the boards and clear what was printed there; the changes are
+ * written at once unless they don't fit in the frame buffer.
+ *
+ * @param[in,out] renderer Pointer to the renderer.
+ * @param[in] boards The left and right game boards, of the size of the renderer.
+ * @param[in] hidden For each board, 1 if its boats must stay hidden.
+ * @param[in] titles Title displayed above each board.
+ *
+ * @note The function exits with an error message if a pointer is NULL or if a board doesn't have the size of the renderer.
+ */
+void renderBoards(Renderer* renderer, Game_board* boards[2], const int hidden[2], const char* titles[2]){
+        if(renderer == NULL || boards == NULL || boards[0] == NULL || boards[1] == NULL || hidden == NULL || titles == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        int size = renderer->size;
+        if(boards[0]->Matrix_size != size || boards[1]->Matrix_size != size){
+                fprintf(stderr,"taille incorrecte");
+                exit(1);
+        }
+        int width = columnWidth(size);
+        int digits = renderDigits(size);
+        char* out = renderer->buffer;
+        size_t length = 0;
+
+        if(renderer->ansi && renderer->drawn){                   //only the cases that changed
+                for(int b = 0; b < 2; b++){
+                        char* previous = renderer->previous + (size_t)b * size * size;
+                        for(size_t i = 0; i < (size_t)size * size; i++){
+                                char symbol = caseSymbol(boards[b]->cells[i],hidden[b]);
+                                if(symbol != previous[i]){
+                                        if(length + 32 > renderer->capacity){           //more changes than a frame holds
+                                                renderWrite(out,length);
+                                                length = 0;
+                                        }
+                                        int column = b * (width + RENDER_GAP) + labelWidth(digits) + (int)(i % size) * (digits + 1) + 1;
+                                        length += sprintf(out + length,"\x1b[%d;%dH%c",(int)(i / size) + 3,column,symbol);
+                                        previous[i] = symbol;
+                                }
+                        }
+                }
+                length += sprintf(out + length,"\x1b[%d;1H\x1b[J",size + 4);
+                renderWrite(out,length);
+                return;
+        }
+
+        if(renderer->ansi){                                      //first frame at the top of a clear screen
+                length += sprintf(out,"\x1b[2J\x1b[H");
+        }
+        for(int b = 0; b < 2; b++){
+                size_t start = length;
+                length += sprintf(out + length,"%.*s",width,titles[b]);
+                length += renderPad(out + length,length - start,(b == 0) ? width + RENDER_GAP : 0);
+        }
+        out[length++] = '\n';
+        for(int b = 0; b < 2; b++){
+                size_t written = renderHeader(out + length,size);
+                length += written;
+                length += renderPad(out + length,written,(b == 0) ? width + RENDER_GAP : 0);
+        }
+        out[length++] = '\n';
+        for(int i = 0; i < size; i++){
+                for(int b = 0; b < 2; b++){
+                        size_t written = renderRow(out + length,boards[b],i,hidden[b]);
+                        length += written;
+                        length += renderPad(out + length,written,(b == 0) ? width + RENDER_GAP : 0);
+                }
+                out[length++] = '\n';
+        }
+        out[length++] = '\n';
+        renderWrite(out,length);
+
+        for(int b = 0; b < 2; b++){                              //what is now on the screen
+                char* previous = renderer->previous + (size_t)b * size * size;
+                for(size_t i = 0; i < (size_t)size * size; i++){
+                        previous[i] = caseSymbol(boards[b]->cells[i],hidden[b]);
+                }
+        }
+        renderer->drawn = 1;
+}
+
+/**
+ * @brief Draws one board alone in a single write.
+ *
+ * @param[in] board Pointer to the game board structure.
+ * @param[in] hidden 1 if the boats of the board must stay hidden.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+void renderBoard(Game_board* board, int hidden){
+        size_t line = (size_t)columnWidth(board->Matrix_size) + 1;
+        char* out = malloc((board->Matrix_size + 2) * line + 1);
+        if(out == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        size_t length = renderHeader(out,board->Matrix_size);
+        out[length++] = '\n';
+        for(int i = 0; i < board->Matrix_size; i++){
+                length += renderRow(out + length,board,i,hidden);
+                out[length++] = '\n';
+        }
+        out[length++] = '\n';
+        renderWrite(out,length);
+        free(out);
+}
+
+/**
+ * @brief Draws the boards of an interactive game: the player's own board and the enemy board with its boats hidden.
+ *
+ * The renderer of the game is created on the first call, in the mode chosen by the --ansi option.
+ *
+ * @param[in,out] game Pointer to the game structure.
+ *
+ * @note The function exits with an error message if the game pointer is NULL.
+ */
+void gameDisplay(Game* game){
+        if(game == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        if(game->renderer == NULL){
+                game->renderer = rendererCreate(game->tab_player->Matrix_size,game_config.ansi);
+        }
+        Game_board* boards[2] = {game->tab_player, game->tab_bot};
+        const int hidden[2] = {0, 1};
+        const char* titles[2] = {" --- VOTRE TABLEAU ---", " --- TABLEAU ENNEMI ---"};
+        renderBoards(game->renderer,boards,hidden,titles);
+}
+
+/**
+ * @brief Frees the memory allocated for a renderer.
+ *
+ * @param[in] renderer Pointer to the renderer to be freed.
+ *
+ * @note If the renderer pointer is NULL, nothing is freed.
+ */
+void rendererFree(Renderer* renderer){
+        if(renderer == NULL){
+                return;
+        }
+        free(renderer->buffer);
+        free(renderer);
+}
@@ -0,0 +1,142 @@
+/**
+ * @file Rng.c
+ * @brief .c file containing the pseudo-random number generator
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * xoshiro256** generator: 32 bytes of state, a few instructions per number and
+ * no shared state, so every thread and every game can own its generator.
+ * Independent generators are obtained either by splitting a generator
+ * (rngSplit, which hands out non-overlapping blocks of 2^128 numbers) or by
+ * deriving the seed of the n-th stream of a run (rngStreamSeed), which only
+ * depends on the run seed and n and lets any game of a run be replayed alone.
+ */
+#include "header.h"
+
+/**
+ * @brief Rotates a 64-bit word to the left.
+ *
+ * @param[in] x The word to rotate.
+ * @param[in] k Number of bits of the rotation.
+ * @return The rotated word.
+ */
+static uint64_t rotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Initializes a generator from a 64-bit seed.
+ *
+ * The four words of the state are expanded from the seed with splitmix64, so
+ * close seeds still give unrelated sequences.
+ *
+ * @param[out] rng Pointer to the generator.
+ * @param[in] seed The seed.
+ *
+ * @note The function exits with an error message if the generator pointer is NULL.
+ */
+void rngSeed(Rng* rng, uint64_t seed){
+        if(rng == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        for(int i = 0; i < 4; i++){
+                uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                rng->s[i] = z ^ (z >> 31);
+        }
+}
+
+/**
+ * @brief Draws the next 64-bit number of a generator.
+ *
+ * @param[in,out] rng Pointer to the generator.
+ * @return A uniformly distributed 64-bit number.
+ */
+uint64_t rngNext(Rng* rng){
+        uint64_t* s = rng->s;
+        uint64_t result = rotl(s[1] * 5,7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3],45);
+        return result;
+}
+
+/**
+ * @brief Advances a generator by 2^128 numbers.
+ *
+ * @param[in,out] rng Pointer to the generator.
+ */
+void rngJump(Rng* rng){
+        static const uint64_t jump[4] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+        uint64_t s[4] = {0, 0, 0, 0};
+        for(int i = 0; i < 4; i++){
+                for(int b = 0; b < 64; b++){
+                        if(jump[i] & ((uint64_t)1 << b)){
+                                for(int k = 0; k < 4; k++){
+                                        s[k] ^= rng->s[k];
+                                }
+                        }
+                        rngNext(rng);
+                }
+        }
+        for(int k = 0; k < 4; k++){
+                rng->s[k] = s[k];
+        }
+}
+
+/**
+ * @brief Splits an independent generator off a generator.
+ *
+ * The child starts where the parent is, and the parent jumps 2^128 numbers
+ * ahead, so the sequences of the parent and of every child never overlap.
+ *
+ * @param[in,out] parent Pointer to the generator to split.
+ * @param[out] child Pointer to the new generator.
+ *
+ * @note The function exits with an error message if a pointer is NULL.
+ */
+void rngSplit(Rng* parent, Rng* child){
+        if(parent == NULL || child == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        *child = *parent;
+        rngJump(parent);
+}
+
+/**
+ * @brief Derives the seed of a stream of a run.
+ *
+ * The seed only depends on the run seed and the index of the stream, so the
+ * n-th game of a run gets the same generator whatever the thread playing it.
+ *
+ * @param[in] seed Seed of the run.
+ * @param[in] index Index of the stream (for instance the number of the game).
+ * @return The seed of the stream.
+ */
+uint64_t rngStreamSeed(uint64_t seed, uint64_t index){
+        uint64_t z = seed ^ (index * 0xD1342543DE82EF95ULL);
+        z = (z ^ (z >> 32)) * 0xD6E8FEB86659FD93ULL;
+        z = (z ^ (z >> 32)) * 0xD6E8FEB86659FD93ULL;
+        return z ^ (z >> 32);
+}
+
+/**
+ * @brief Draws a number between 0 and bound - 1.
+ *
+ * The number is the high part of a 32x32-bit product instead of a modulo, the
+ * bias being negligible for the small bounds of the game.
+ *
+ * @param[in,out] rng Pointer to the generator.
+ * @param[in] bound Number of possible values, must be positive.
+ * @return A number in [0, bound).
+ */
+int rngBounded(Rng* rng, int bound){
+        return (int)(((rngNext(rng) >> 32) * (uint64_t)bound) >> 32);
+}
@@ -0,0 +1,431 @@
+/**
+ * @file Save.c
+ * @brief .c file containing the binary snapshots of games
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * A snapshot is a fixed-layout copy of a whole game: a header (format, version,
+ * configuration, seat to play, shots, generator state) followed, for each board,
+ * by its bitboard, its fleet and the block holding its cases, boat index, hit
+ * counters and list of cases not shot yet, copied as they are in memory. A game
+ * is saved and restored with a few memcpy and no per-case parsing, and every
+ * snapshot of a configuration has the same size, so a file of checkpoints is
+ * written with a single write and read back through mmap.
+ *
+ * The integers are stored in the byte order of the machine, which is recorded
+ * in the header so a snapshot written on another kind of machine is refused.
+ */
+#include "header.h"
+
+#define SAVE_MAGIC "BNAV"       /**< First bytes of every snapshot. */
+#define SAVE_VERSION 2          /**< Version of the layout, changed whenever it changes. */
+#define SAVE_BYTE_ORDER 0x01020304u   /**< Written in the byte order of the machine. */
+
+_Static_assert(sizeof(Case_type) == sizeof(int32_t), "the cases are saved as 32-bit integers");
+_Static_assert(sizeof(Boat) == 4 * sizeof(int32_t), "the boats are saved as four 32-bit integers");
+
+/**
+ * @brief Structure representing the header of a snapshot.
+ */
+typedef struct{
+        char magic[4];        /**< SAVE_MAGIC. */
+        uint32_t version;     /**< SAVE_VERSION. */
+        uint32_t byte_order;  /**< SAVE_BYTE_ORDER. */
+        uint32_t plate_size;  /**< Size of the game boards. */
+        uint32_t boat_nb;     /**< Number of boats of each fleet. */
+        int32_t turn;         /**< Seat to shoot next. */
+        int32_t winner;       /**< Winning seat, -1 while the game goes on. */
+        int32_t shots[2];     /**< Number of missiles fired by each seat. */
+        uint32_t reserved;    /**< Zero. */
+        uint64_t rng[4];      /**< State of the generator of the game. */
+        uint64_t size;        /**< Size of the whole snapshot, header included. */
+}Save_header;
+
+/**
+ * @brief Structure representing the fixed part of a saved board.
+ */
+typedef struct{
+        Bit_board bits;       /**< Bitboard copy of the board. */
+        int32_t boats_alive;  /**< Boats of the fleet not sunk yet. */
+        int32_t nb_unshot;    /**< Cases not shot yet. */
+}Save_board;
+
+/**
+ * @brief Gives the size of the block of cases, boat index, hit counters and cases not shot yet of a board.
+ *
+ * @return The size of the block, in bytes.
+ */
+static size_t boardBlockSize(){
+        size_t nb_cells = (size_t)game_config.plate_size * game_config.plate_size;
+        return nb_cells * (sizeof(Case_type) + 3 * sizeof(int)) + game_config.boat_nb * sizeof(int);
+}
+
+/**
+ * @brief Gives the size of a saved board.
+ *
+ * @return The size of the saved board, in bytes.
+ */
+static size_t boardSnapshotSize(){
+        return sizeof(Save_board) + game_config.boat_nb * sizeof(Boat) + boardBlockSize();
+}
+
+/**
+ * @brief Gives the size of the snapshot of a game of the current configuration.
+ *
+ * The size is rounded up to 16 bytes so the snapshots of a file stay aligned.
+ *
+ * @return The size of a snapshot, in bytes.
+ */
+size_t gameSnapshotSize(){
+        size_t size = sizeof(Save_header) + 2 * boardSnapshotSize();
+        return (size + 15) & ~(size_t)15;
+}
+
+/**
+ * @brief Copies a board and its fleet into a snapshot.
+ *
+ * @param[in] board Pointer to the game board structure.
+ * @param[in] boat_list Pointer to the array of the boats of the board.
+ * @param[out] out Where the board is copied.
+ * @return The position after the copied board.
+ */
+static char* boardSnapshot(Game_board* board, Boat* boat_list, char* out){
+        Save_board fixed;
+        memset(&fixed,0,sizeof(fixed));
+        fixed.bits = board->bits;
+        fixed.boats_alive = board->boats_alive;
+        fixed.nb_unshot = board->nb_unshot;
+        memcpy(out,&fixed,sizeof(fixed));
+        out += sizeof(fixed);
+        memcpy(out,boat_list,game_config.boat_nb * sizeof(Boat));
+        out += game_config.boat_nb * sizeof(Boat);
+        memcpy(out,board->cells,boardBlockSize());               //cases, boat index, hit counters and cases not shot yet follow each other
+        return out + boardBlockSize();
+}
+
+/**
+ * @brief Copies a board and its fleet out of a snapshot.
+ *
+ * @param[out] board Pointer to the game board structure, of the size of the configuration.
+ * @param[out] boat_list Pointer to the array of the boats of the board.
+ * @param[in] in Where the board was copied.
+ * @return The position after the copied board.
+ */
+static const char* boardRestore(Game_board* board, Boat* boat_list, const char* in){
+        Save_board fixed;
+        memcpy(&fixed,in,sizeof(fixed));
+        board->bits = fixed.bits;
+        board->boats_alive = fixed.boats_alive;
+        board->nb_unshot = fixed.nb_unshot;
+        in += sizeof(fixed);
+        memcpy(boat_list,in,game_config.boat_nb * sizeof(Boat));
+        in += game_config.boat_nb * sizeof(Boat);
+        memcpy(board->cells,in,boardBlockSize());
+        return in + boardBlockSize();
+}
+
+/**
+ * @brief Checks that a restored board and its fleet can be played without reading or writing out of their arrays.
+ *
+ * Every count, index and boat position read from the file is checked: the
+ * number of cases not shot yet and of boats alive, the list of cases not shot
+ * yet and their positions in it, the kind of each case and its boat index, and
+ * the place and intact cases of each boat.
+ *
+ * @param[in] board Pointer to the restored game board.
+ * @param[in] boat_list Pointer to the array of the restored boats.
+ * @return 1 if the board is valid, 0 otherwise.
+ */
+static int boardValid(const Game_board* board, const Boat* boat_list){
+        int n = board->Matrix_size;
+        int nb_cells = n * n;
+        int nb = game_config.boat_nb;
+        if(board->nb_unshot < 0 || board->nb_unshot > nb_cells || board->boats_alive < 0 || board->boats_alive > nb){
+                return 0;
+        }
+        for(int i = 0; i < nb; i++){
+                const Boat* boat = &boat_list[i];
+                if(boat->orientation < 0 || boat->orientation > 1 || boat->x_pos < 0 || boat->y_pos < 0 ||
+                   boat->x_pos + (boat->boat_size - 1) * (1 - boat->orientation) >= n || boat->y_pos + (boat->boat_size - 1) * boat->orientation >= n ||
+                   board->hits_left[i] < 0 || board->hits_left[i] > boat->boat_size){
+                        return 0;
+                }
+        }
+        for(int i = 0; i < nb_cells; i++){
+                Case_type type = board->cells[i];
+                if(type < WATER || type > WRECK || ((type == BOAT || type == WRECK) && (board->boat_ids[i] < 0 || board->boat_ids[i] >= nb))){
+                        return 0;
+                }
+        }
+        for(int i = 0; i < board->nb_unshot; i++){
+                int cell = board->unshot[i];
+                if(cell < 0 || cell >= nb_cells || board->unshot_pos[cell] != i){
+                        return 0;
+                }
+        }
+        return 1;
+}
+
+/**
+ * @brief Writes the snapshot of a game into a buffer.
+ *
+ * @param[in] game Pointer to the game to save.
+ * @param[out] buffer Buffer of gameSnapshotSize() bytes.
+ *
+ * @note The function exits with an error message if a pointer is NULL.
+ */
+void gameSnapshot(Game* game, void* buffer){
+        if(game == NULL || buffer == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Save_header header;
+        memset(&header,0,sizeof(header));
+        memcpy(header.magic,SAVE_MAGIC,4);
+        header.version = SAVE_VERSION;
+        header.byte_order = SAVE_BYTE_ORDER;
+        header.plate_size = game_config.plate_size;
+        header.boat_nb = game_config.boat_nb;
+        header.turn = game->turn;
+        header.winner = game->winner;
+        header.shots[0] = game->shots[0];
+        header.shots[1] = game->shots[1];
+        memcpy(header.rng,game->rng.s,sizeof(header.rng));
+        header.size = gameSnapshotSize();
+        char* out = buffer;
+        memset(out,0,header.size);
+        memcpy(out,&header,sizeof(header));
+        out = boardSnapshot(game->tab_player,game->boat_tab_player,out + sizeof(header));
+        boardSnapshot(game->tab_bot,game->boat_tab_bot,out);
+}
+
+/**
+ * @brief Creates a game from its snapshot.
+ *
+ * The snapshot must have been written with the same board size and fleet as the
+ * current configuration.
+ *
+ * @param[in] buffer The snapshot.
+ * @param[in] size Number of bytes available in the buffer.
+ * @return A pointer to the restored game.
+ *
+ * @note The function exits with an error message if the snapshot is invalid (a seat, a count, an index or a
+ * boat out of range included), was written with another version, machine or configuration, or if memory
+ * allocation fails.
+ */
+Game* gameRestore(const void* buffer, size_t size){
+        if(buffer == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Save_header header;
+        if(size < sizeof(header)){
+                fprintf(stderr,"Sauvegarde tronquée");
+                exit(5);
+        }
+        memcpy(&header,buffer,sizeof(header));
+        if(memcmp(header.magic,SAVE_MAGIC,4) != 0 || header.byte_order != SAVE_BYTE_ORDER){
+                fprintf(stderr,"Ce fichier n'est pas une sauvegarde de cette machine");
+                exit(5);
+        }
+        if(header.version != SAVE_VERSION){
+                fprintf(stderr,"Version de sauvegarde non supportée: %u",header.version);
+                exit(5);
+        }
+        if(header.plate_size != (uint32_t)game_config.plate_size || header.boat_nb != (uint32_t)game_config.boat_nb || header.size != gameSnapshotSize()){
+                fprintf(stderr,"La sauvegarde a été faite avec un autre plateau ou une autre flotte");
+                exit(5);
+        }
+        if(size < header.size){
+                fprintf(stderr,"Sauvegarde tronquée");
+                exit(5);
+        }
+        void* block = aligned_alloc(16,gameBlockSize());
+        if(block == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        Game* game = gamePlace(block);
+        game->turn = header.turn;
+        game->winner = header.winner;
+        game->shots[0] = header.shots[0];
+        game->shots[1] = header.shots[1];
+        memcpy(game->rng.s,header.rng,sizeof(header.rng));
+        const char* in = (const char*)buffer + sizeof(header);
+        in = boardRestore(game->tab_player,game->boat_tab_player,in);
+        boardRestore(game->tab_bot,game->boat_tab_bot,in);
+        for(int i = 0; i < game_config.boat_nb; i++){
+                if(game->boat_tab_player[i].boat_size != game_config.boat_sizes[i] || game->boat_tab_bot[i].boat_size != game_config.boat_sizes[i]){
+                        fprintf(stderr,"La sauvegarde a été faite avec un autre plateau ou une autre flotte");
+                        exit(5);
+                }
+        }
+        if(game->turn < 0 || game->turn > 1 || game->winner < -1 || game->winner > 1 ||
+           !boardValid(game->tab_player,game->boat_tab_player) || !boardValid(game->tab_bot,game->boat_tab_bot)){
+                fprintf(stderr,"Ce fichier n'est pas une sauvegarde valide");
+                exit(5);
+        }
+        return game;
+}
+
+/**
+ * @brief Saves games in a file with a single write.
+ *
+ * @param[in] games Array of the games to save.
+ * @param[in] nb Number of games.
+ * @param[in] path Path of the file, replaced if it exists.
+ *
+ * @note The function exits with an error message if a parameter is invalid, if the file can't be written or if memory allocation fails.
+ */
+void saveGames(Game** games, int nb, const char* path){
+        if(games == NULL || nb < 0 || path == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        size_t snapshot_size = gameSnapshotSize();
+        size_t length = nb * snapshot_size;
+        char* buffer = malloc(length > 0 ? length : 1);
+        if(buffer == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        for(int i = 0; i < nb; i++){
+                gameSnapshot(games[i],buffer + i * snapshot_size);
+        }
+        int fd = open(path,O_WRONLY | O_CREAT | O_TRUNC,0644);
+        if(fd < 0){
+                fprintf(stderr,"Impossible d'ouvrir %s",path);
+                exit(5);
+        }
+        for(size_t done = 0; done < length; ){
+                ssize_t written = write(fd,buffer + done,length - done);
+                if(written <= 0){
+                        fprintf(stderr,"Erreur d'écriture dans %s",path);
+                        exit(5);
+                }
+                done += written;
+        }
+        close(fd);
+        free(buffer);
+}
+
+/**
+ * @brief Loads every game saved in a file by saveGames.
+ *
+ * The file is mapped in memory and each game is restored straight from the mapping.
+ *
+ * @param[in] path Path of the file.
+ * @param[out] nb Number of games loaded.
+ * @return An array of the loaded games, to be freed with free after freeGame on each game.
+ *
+ * @note The function exits with an error message if a pointer is NULL, if the file can't be read or is invalid, or if memory allocation fails.
+ */
+Game** loadGames(const char* path, int* nb){
+        if(path == NULL || nb == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        int fd = open(path,O_RDONLY);
+        struct stat info;
+        if(fd < 0 || fstat(fd,&info) != 0){
+                fprintf(stderr,"Impossible d'ouvrir %s",path);
+                exit(5);
+        }
+        size_t snapshot_size = gameSnapshotSize();
+        if((size_t)info.st_size % snapshot_size != 0){
+                fprintf(stderr,"La sauvegarde a été faite avec un autre plateau ou une autre flotte");
+                exit(5);
+        }
+        *nb = info.st_size / snapshot_size;
+        Game** games = malloc((*nb > 0 ? *nb : 1) * sizeof(Game*));
+        if(games == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        if(*nb > 0){
+                const char* data = mmap(NULL,info.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+                if(data == MAP_FAILED){
+                        fprintf(stderr,"Impossible de lire %s",path);
+                        exit(5);
+                }
+                for(int i = 0; i < *nb; i++){
+                        games[i] = gameRestore(data + i * snapshot_size,snapshot_size);
+                }
+                munmap((void*)data,info.st_size);
+        }
+        close(fd);
+        return games;
+}
+
+/**
+ * @brief Starts games between two bots, plays their first shots and saves them in a file.
+ *
+ * @param[in] path Path of the file of checkpoints.
+ * @param[in] nb_games Number of games.
+ * @param[in] nb_shots Number of shots played in each game before it is saved.
+ * @param[in] bot_player Strategy of the player seat.
+ * @param[in] bot_ennemy Strategy of the bot seat.
+ * @param[in] seed Seed of the run, game i being played with rngStreamSeed(seed, i).
+ *
+ * @note The function exits with an error message if the parameters are invalid or if the file can't be written.
+ */
+void runCheckpoint(const char* path, int nb_games, long nb_shots, Bot_type bot_player, Bot_type bot_ennemy, uint64_t seed){
+        if(path == NULL || nb_games < 1 || nb_shots < 0){
+                fprintf(stderr,"Paramètres invalides");
+                exit(2);
+        }
+        check_const();
+        Game** games = malloc(nb_games * sizeof(Game*));
+        if(games == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        for(int i = 0; i < nb_games; i++){
+                games[i] = createGame(rngStreamSeed(seed,i));
+                startSimulatedGame(games[i]);
+                resumeSimulatedGame(games[i],bot_player,bot_ennemy,nb_shots);
+        }
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        saveGames(games,nb_games,path);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        printf("%d parties sauvegardées après %ld tirs dans %s (%zu octets par partie) en %.3f ms\n",nb_games,nb_shots,path,gameSnapshotSize(),elapsed * 1e3);
+        for(int i = 0; i < nb_games; i++){
+                freeGame(games[i]);
+        }
+        free(games);
+}
+
+/**
+ * @brief Loads the games of a file of checkpoints and plays them to the end.
+ *
+ * @param[in] path Path of the file of checkpoints.
+ * @param[in] bot_player Strategy of the player seat.
+ * @param[in] bot_ennemy Strategy of the bot seat.
+ *
+ * @note The function exits with an error message if the file can't be read or is invalid.
+ */
+void runResume(const char* path, Bot_type bot_player, Bot_type bot_ennemy){
+        check_const();
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        int nb_games;
+        Game** games = loadGames(path,&nb_games);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        long wins[2] = {0, 0};
+        long shots = 0;
+        for(int i = 0; i < nb_games; i++){
+                resumeSimulatedGame(games[i],bot_player,bot_ennemy,-1);
+                wins[games[i]->winner]++;
+                shots += games[i]->shots[0] + games[i]->shots[1];
+                freeGame(games[i]);
+        }
+        free(games);
+        printf("%d parties chargées depuis %s en %.3f ms\n",nb_games,path,elapsed * 1e3);
+        if(nb_games > 0){
+                printf("Victoires: joueur %ld (%.2f%%) - bot %ld (%.2f%%)\n",wins[0],100.0 * wins[0] / nb_games,wins[1],100.0 * wins[1] / nb_games);
+                printf("Tirs moyens par partie: %.2f\n",(double)shots / nb_games);
+        }
+}
@@ -0,0 +1,399 @@
+/**
+ * @file Script.c
+ * @brief .c file containing the scripted mode, playing streams of shots sent by another program
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The scripted mode plays against the bot like the interactive game, but reads
+ * its shots as a stream of commands from the standard input or a file, many per
+ * read, and answers in a compact form on the standard output, written in big
+ * blocks. No prompt is displayed and no scanf is involved: the commands are parsed
+ * by hand in the read buffer.
+ *
+ * In text, a command is a line: "x y" shoots (the coordinates may also be separated
+ * by a comma or a semicolon) and "N" starts a new game. The answer is one line per
+ * command: "R" (miss), "T" (hit), "C<size>" (sunk) or "D" (already shot), followed,
+ * when the hand goes to the bot, by one "x,y:R|T|C<size>" token per bot shot and, at
+ * the end of the game, by "G" (won) or "P" (lost); "N" answers a new game and "E" a
+ * wrong command.
+ *
+ * In binary, a command is a record of two int16_t in the byte order of the machine,
+ * x then y, x = -1 starting a new game. The answer is one 8-byte record per shot, of
+ * the player first then of the bot: int16_t x and y, then the bytes seat (0 for the
+ * player, 1 for the bot), result (a Shot_result, SCRIPT_NEW for a new game or
+ * SCRIPT_ERROR for a wrong command), size of the boat sunk (0 otherwise) and state
+ * of the game (0 while it goes on, 1 if the player won, 2 if the bot won).
+ *
+ * A shot after the end of a game starts the next one, so a client doesn't need
+ * a round trip between games. The game n of a run has the seed rngStreamSeed(seed, n),
+ * as the simulations.
+ */
+#include "header.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <errno.h>
+
+#define SCRIPT_BUFFER 65536   /**< Size of the input and output buffers. */
+#define SCRIPT_LINE 64        /**< Longest text command accepted, end of line included. */
+#define SCRIPT_NEW 254        /**< Result of the binary answer to a new game. */
+#define SCRIPT_ERROR 255      /**< Result of the binary answer to a wrong command. */
+
+/**
+ * @brief Structure representing an answer record of the binary protocol.
+ */
+typedef struct{
+        int16_t x;            /**< X-coordinate of the shot. */
+        int16_t y;            /**< Y-coordinate of the shot. */
+        uint8_t seat;         /**< 0 for a shot of the player, 1 for a shot of the bot. */
+        uint8_t result;       /**< Shot_result of the shot, SCRIPT_NEW or SCRIPT_ERROR. */
+        uint8_t size;         /**< Size of the boat sunk, 0 if none. */
+        uint8_t state;        /**< 0 while the game goes on, 1 if the player won, 2 if the bot won. */
+}Script_answer;
+
+/**
+ * @brief Structure representing a scripted run: its game and its output buffer.
+ */
+typedef struct{
+        Game* game;           /**< Game being played, NULL before the first command. */
+        long nb_games;        /**< Number of games started. */
+        long nb_commands;     /**< Number of commands read. */
+        Bot_type bot;         /**< Strategy of the bot. */
+        int binary;           /**< 1 for the binary protocol, 0 for text. */
+        char out[SCRIPT_BUFFER]; /**< Answers not written yet. */
+        size_t out_length;    /**< Number of bytes in out. */
+}Script;
+
+/**
+ * @brief Writes the answers waiting in the output buffer.
+ *
+ * @param[in,out] script Pointer to the run.
+ *
+ * @note The function exits with an error message if the standard output can't be written.
+ */
+static void scriptFlush(Script* script){
+        size_t written = 0;
+        while(written < script->out_length){
+                ssize_t nb = write(1,script->out + written,script->out_length - written);
+                if(nb < 0 && errno == EINTR){
+                        continue;
+                }
+                if(nb <= 0){
+                        fprintf(stderr,"Erreur lors de l'écriture des réponses");
+                        exit(5);
+                }
+                written += nb;
+        }
+        script->out_length = 0;
+}
+
+/**
+ * @brief Makes room in the output buffer, writing it if needed.
+ *
+ * @param[in,out] script Pointer to the run.
+ * @param[in] length Number of bytes to be added, at most SCRIPT_BUFFER.
+ * @return A pointer to where the bytes go.
+ */
+static char* scriptReserve(Script* script, size_t length){
+        if(script->out_length + length > SCRIPT_BUFFER){
+                scriptFlush(script);
+        }
+        return script->out + script->out_length;
+}
+
+/**
+ * @brief Writes a non negative number in decimal.
+ *
+ * @param[out] out Where the digits go, room for 11 characters.
+ * @param[in] value The number.
+ * @return The number of characters written.
+ */
+static int scriptNumber(char* out, int value){
+        char digits[12];
+        int nb = 0;
+        do{
+                digits[nb++] = '0' + value % 10;
+                value /= 10;
+        }while(value != 0);
+        for(int i = 0; i < nb; i++){
+                out[i] = digits[nb - 1 - i];
+        }
+        return nb;
+}
+
+/**
+ * @brief Adds the answer to a shot, or to another command, to the output buffer.
+ *
+ * @param[in,out] script Pointer to the run.
+ * @param[in] seat 0 for a shot of the player, 1 for a shot of the bot.
+ * @param[in] x X-coordinate of the shot.
+ * @param[in] y Y-coordinate of the shot.
+ * @param[in] result Shot_result of the shot, SCRIPT_NEW or SCRIPT_ERROR.
+ * @param[in] size Size of the boat sunk, 0 if none.
+ */
+static void scriptAnswer(Script* script, int seat, int x, int y, int result, int size){
+        if(script->binary){
+                Script_answer answer = {x, y, seat, result, size, 0};
+                memcpy(scriptReserve(script,sizeof(answer)),&answer,sizeof(answer));
+                script->out_length += sizeof(answer);
+                return;
+        }
+        char* out = scriptReserve(script,40);
+        int length = 0;
+        if(seat == 1){                                          //bot shots follow the answer of the player on its line
+                out[length++] = ' ';
+                length += scriptNumber(out + length,x);
+                out[length++] = ',';
+                length += scriptNumber(out + length,y);
+                out[length++] = ':';
+        }
+        switch(result){
+                case SHOT_MISS:
+                        out[length++] = 'R';
+                        break;
+                case SHOT_HIT:
+                        out[length++] = 'T';
+                        break;
+                case SHOT_SUNK:
+                        out[length++] = 'C';
+                        length += scriptNumber(out + length,size);
+                        break;
+                case SHOT_ALREADY:
+                        out[length++] = 'D';
+                        break;
+                case SCRIPT_NEW:
+                        out[length++] = 'N';
+                        break;
+                default:
+                        out[length++] = 'E';
+        }
+        script->out_length += length;
+}
+
+/**
+ * @brief Marks the end of the game in the answer to the last shot.
+ *
+ * @param[in,out] script Pointer to the run.
+ * @param[in] winner Winning seat.
+ */
+static void scriptGameOver(Script* script, int winner){
+        if(script->binary){
+                script->out[script->out_length - sizeof(Script_answer) + offsetof(Script_answer,state)] = 1 + winner;   //the record was just added
+                return;
+        }
+        char* out = scriptReserve(script,2);
+        out[0] = ' ';
+        out[1] = (winner == 0) ? 'G' : 'P';
+        script->out_length += 2;
+}
+
+/**
+ * @brief Starts the next game of the run.
+ *
+ * @param[in,out] script Pointer to the run.
+ */
+static void scriptNewGame(Script* script){
+        uint64_t seed = rngStreamSeed(game_config.seed,script->nb_games++);
+        if(script->game == NULL){
+                script->game = createGame(seed);
+        }
+        else{
+                gameReset(script->game,seed);
+        }
+        startSimulatedGame(script->game);
+}
+
+/**
+ * @brief Plays a shot of the player, then the shots of the bot if the hand goes to it, and answers them.
+ *
+ * @param[in,out] script Pointer to the run.
+ * @param[in] x X-coordinate of the shot.
+ * @param[in] y Y-coordinate of the shot.
+ */
+static void scriptShot(Script* script, int x, int y){
+        if(x < 0 || y < 0 || x >= game_config.plate_size || y >= game_config.plate_size){
+                scriptAnswer(script,0,x,y,SCRIPT_ERROR,0);
+                return;
+        }
+        if(script->game == NULL || script->game->winner >= 0){
+                scriptNewGame(script);
+        }
+        Game* game = script->game;
+        Game_event event;
+        seatBind(game,0,BOT_HUMAN);                             //the player seat shoots the cases of the script
+        seatBind(game,1,script->bot);
+        gameInput(game,x,y);
+        while(gameStep(game,&event) == GAME_SHOT){            //until the hand comes back to the script or the game ends
+                scriptAnswer(script,event.seat,event.x,event.y,event.result,event.result == SHOT_SUNK ? game_config.boat_sizes[event.boat_id] : 0);
+        }
+        if(game->winner >= 0){
+                scriptGameOver(script,game->winner);
+                statsGame(game->shots[0] + game->shots[1]);
+                moveLogFlush(game_config.log);
+        }
+}
+
+/**
+ * @brief Reads a non negative number in a text command.
+ *
+ * @param[in,out] cursor Pointer to the current character, moved after the number.
+ * @param[in] end End of the command.
+ * @return The number, -1 if there is no number or if it is too big.
+ */
+static int scriptParseNumber(const char** cursor, const char* end){
+        const char* c = *cursor;
+        int value = 0;
+        if(c == end || *c < '0' || *c > '9'){
+                return -1;
+        }
+        while(c < end && *c >= '0' && *c <= '9'){
+                value = 10 * value + (*c++ - '0');
+                if(value > 1000000){
+                        return -1;
+                }
+        }
+        *cursor = c;
+        return value;
+}
+
+/**
+ * @brief Executes a text command.
+ *
+ * @param[in,out] script Pointer to the run.
+ * @param[in] line The command.
+ * @param[in] end End of the command, its end of line excluded.
+ */
+static void scriptTextCommand(Script* script, const char* line, const char* end){
+        while(end > line && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')){
+                end--;
+        }
+        while(line < end && (*line == ' ' || *line == '\t')){
+                line++;
+        }
+        if(line == end){                                        //empty lines are ignored
+                return;
+        }
+        script->nb_commands++;
+        if(end - line == 1 && (*line == 'N' || *line == 'n')){
+                scriptNewGame(script);
+                scriptAnswer(script,0,-1,-1,SCRIPT_NEW,0);
+        }
+        else{
+                int x = scriptParseNumber(&line,end);
+                int separators = 0;
+                while(line < end && (*line == ' ' || *line == '\t' || *line == ',' || *line == ';')){
+                        line++;
+                        separators++;
+                }
+                int y = scriptParseNumber(&line,end);
+                if(x < 0 || y < 0 || separators == 0 || line != end){
+                        scriptAnswer(script,0,-1,-1,SCRIPT_ERROR,0);
+                }
+                else{
+                        scriptShot(script,x,y);
+                }
+        }
+        *scriptReserve(script,1) = '\n';
+        script->out_length++;
+}
+
+/**
+ * @brief Plays the commands of a stream and writes the answers on the standard output.
+ *
+ * The stream is read SCRIPT_BUFFER bytes at a time and every complete command of
+ * a read is played before the next read; the answers of a read are written at
+ * once after it (or when the output buffer is full), so a client may as well wait
+ * for the answer of each command as send thousands of them without waiting. The number of commands, of games
+ * and the throughput are displayed on the error output at the end.
+ *
+ * @param[in] path Path of the file of commands, "-" for the standard input.
+ * @param[in] binary 1 for the binary protocol, 0 for text.
+ * @param[in] bot Strategy of the bot.
+ *
+ * @note The function exits with an error message if the file can't be opened or read, or if memory allocation fails.
+ */
+void runScript(const char* path, int binary, Bot_type bot){
+        check_const();
+        int fd = (strcmp(path,"-") == 0) ? 0 : open(path,O_RDONLY);
+        Script* script = calloc(1,sizeof(Script));
+        char* in = malloc(SCRIPT_BUFFER + SCRIPT_LINE);
+        if(fd < 0){
+                fprintf(stderr,"Impossible d'ouvrir le fichier %s",path);
+                exit(5);
+        }
+        if(script == NULL || in == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        script->bot = bot;
+        script->binary = binary;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        size_t length = 0;                                      //bytes of an incomplete command kept from the previous read
+        int skipping = 0;                                       //1 while the rest of a too long text line is skipped
+        while(1){
+                ssize_t nb = read(fd,in + length,SCRIPT_BUFFER);
+                if(nb < 0 && errno == EINTR){
+                        continue;
+                }
+                if(nb < 0){
+                        fprintf(stderr,"Erreur lors de la lecture des commandes");
+                        exit(5);
+                }
+                length += nb;
+                size_t done = 0;
+                if(binary){
+                        for(; done + 2 * sizeof(int16_t) <= length; done += 2 * sizeof(int16_t)){
+                                int16_t shot[2];
+                                memcpy(shot,in + done,sizeof(shot));
+                                script->nb_commands++;
+                                if(shot[0] == -1){
+                                        scriptNewGame(script);
+                                        scriptAnswer(script,0,-1,-1,SCRIPT_NEW,0);
+                                }
+                                else{
+                                        scriptShot(script,shot[0],shot[1]);
+                                }
+                        }
+                }
+                else{
+                        char* newline;
+                        while((newline = memchr(in + done,'\n',length - done)) != NULL){
+                                if(!skipping){
+                                        scriptTextCommand(script,in + done,newline);
+                                }
+                                skipping = 0;
+                                done = newline + 1 - in;
+                        }
+                        if(nb == 0 && done < length && !skipping){      //last line without its end of line
+                                scriptTextCommand(script,in + done,in + length);
+                                done = length;
+                        }
+                        if(length - done >= SCRIPT_LINE){            //a line this long isn't a command
+                                if(!skipping){
+                                        script->nb_commands++;
+                                        scriptAnswer(script,0,-1,-1,SCRIPT_ERROR,0);
+                                        *scriptReserve(script,1) = '\n';
+                                        script->out_length++;
+                                }
+                                skipping = 1;
+                                done = length;
+                        }
+                }
+                length -= done;
+                memmove(in,in + done,length);
+                scriptFlush(script);                            //the answers of a read at once, before waiting for the next commands
+                if(nb == 0){
+                        break;
+                }
+        }
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        fprintf(stderr,"%ld commandes, %ld parties en %.3f s (%.0f commandes/s)\n",script->nb_commands,script->nb_games,seconds,
+                seconds > 0 ? script->nb_commands / seconds : 0.0);
+        if(fd != 0){
+                close(fd);
+        }
+        freeGame(script->game);
+        free(script);
+        free(in);
+}
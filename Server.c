@@ -0,0 +1,496 @@
+/**
+ * @file Server.c
+ * @brief .c file containing the multi-session game server
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The server accepts many human players on a loopback TCP port, each of them
+ * playing against a bot. The sessions are spread over a few event-loop threads:
+ * each thread owns a listening socket bound to the same port (SO_REUSEPORT, the
+ * kernel balancing the connections between them) and an epoll instance, and
+ * serves its sessions with non-blocking reads and writes, so no thread ever
+ * waits for a player. A session only holds its socket and a line of input; its
+ * Game is taken from the pool of its thread by its first command and stepped like the
+ * interactive game (startSimulatedGame, gameInput, gameStep), the player seat waiting for its commands.
+ *
+ * The protocol is made of text lines. The server greets with
+ * "BATAILLE <size> <boats>" and answers every command with lines ending with
+ * "PRET" (the player may shoot), "GAGNE" or "PERDU" (the game is over):
+ *   - "TIR x y": "RATE", "TOUCHE", "COULE <size>" or "DEJA"; when the hand goes
+ *     to the bot, one "BOT x y RATE|TOUCHE|COULE <size>" line per bot shot;
+ *   - "GRILLE": the player's board then the enemy board, one line per row;
+ *   - "NOUVELLE": starts a new game;
+ *   - "QUITTER": closes the session.
+ * Unknown commands are answered with "ERREUR <reason>".
+ */
+#define _GNU_SOURCE                   //accept4
+#include "header.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#define SERVER_LINE 64        /**< Longest command accepted, end of line included. */
+#define SERVER_EVENTS 256     /**< Events read by one call to epoll_wait. */
+
+/**
+ * @brief Structure representing the session of a connected player.
+ */
+typedef struct{
+        int fd;               /**< Socket of the player. */
+        Game* game;           /**< Game of the session, NULL until the first command. */
+        int in_length;        /**< Characters of an incomplete command in the input line. */
+        char in[SERVER_LINE]; /**< Input line. */
+        char* out;            /**< Answer not sent yet because the socket was full, NULL if none. */
+        size_t out_length;    /**< Characters of the answer not sent yet. */
+}Session;
+
+/**
+ * @brief Structure representing an answer being formatted by an event-loop thread.
+ */
+typedef struct{
+        char* data;           /**< Characters of the answer. */
+        size_t length;        /**< Number of characters. */
+        size_t capacity;      /**< Size of the buffer. */
+}Reply;
+
+/**
+ * @brief Structure representing the argument of an event-loop thread.
+ */
+typedef struct{
+        int port;             /**< Loopback port to listen on. */
+        Bot_type bot;         /**< Strategy of the bots. */
+}Server_loop;
+
+static uint64_t next_session = 0;     /**< Number of the next session, the game seed of session n being rngStreamSeed(seed, n). */
+
+/**
+ * @brief Makes room in an answer.
+ *
+ * @param[in,out] reply Pointer to the answer.
+ * @param[in] length Number of characters to be added.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+static void replyReserve(Reply* reply, size_t length){
+        if(reply->length + length <= reply->capacity){
+                return;
+        }
+        while(reply->length + length > reply->capacity){
+                reply->capacity = (reply->capacity == 0) ? 4096 : 2 * reply->capacity;
+        }
+        reply->data = realloc(reply->data,reply->capacity);
+        if(reply->data == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+}
+
+/**
+ * @brief Adds a formatted line to an answer.
+ *
+ * @param[in,out] reply Pointer to the answer.
+ * @param[in] format printf format of the line, end of line included.
+ */
+static void replyAdd(Reply* reply, const char* format, ...) __attribute__((format(printf,2,3)));
+static void replyAdd(Reply* reply, const char* format, ...){
+        replyReserve(reply,64);
+        va_list args;
+        va_start(args,format);
+        reply->length += vsnprintf(reply->data + reply->length,64,format,args);
+        va_end(args);
+}
+
+/**
+ * @brief Gives the word of the protocol for the result of a shot.
+ *
+ * @param[in] result Result of the shot.
+ * @return "RATE", "TOUCHE", "COULE" or "DEJA".
+ */
+static const char* shotWord(Shot_result result){
+        switch(result){
+                case SHOT_MISS:
+                        return "RATE";
+                case SHOT_HIT:
+                        return "TOUCHE";
+                case SHOT_SUNK:
+                        return "COULE";
+                default:
+                        return "DEJA";
+        }
+}
+
+/**
+ * @brief Starts a new game in a session, the player seat taking its cases from the commands.
+ *
+ * @param[in,out] session Pointer to the session.
+ * @param[in] bot Strategy of the bot.
+ */
+static void sessionNewGame(Session* session, Bot_type bot){
+        uint64_t seed = rngStreamSeed(game_config.seed,__atomic_fetch_add(&next_session,1,__ATOMIC_RELAXED));
+        if(session->game == NULL){                              //from the pool of the event-loop thread, which serves the session until it ends
+                session->game = gamePoolTake(gamePoolThread(),seed);
+        }
+        else{
+                gameReset(session->game,seed);
+        }
+        startSimulatedGame(session->game);
+        seatBind(session->game,0,BOT_HUMAN);                    //the player seat shoots the cases given by TIR
+        seatBind(session->game,1,bot);
+}
+
+/**
+ * @brief Steps the game of a session until it waits for the next case of the player or is over, and answers every shot.
+ *
+ * The player seat is BOT_HUMAN, fed with gameInput, so the shot of the player
+ * and the shots of the bot that follow when the hand passes are all played here
+ * without ever blocking the event loop.
+ *
+ * @param[in,out] game Pointer to the game of the session, whose seats were bound by sessionNewGame.
+ * @param[in,out] reply Pointer to the answer.
+ */
+static void sessionSteps(Game* game, Reply* reply){
+        Game_event event;
+        while(gameStep(game,&event) == GAME_SHOT){
+                if(event.seat == 1){
+                        replyAdd(reply,"BOT %d %d ",event.x,event.y);
+                }
+                if(event.result == SHOT_SUNK){
+                        replyAdd(reply,"COULE %d\n",game_config.boat_sizes[event.boat_id]);
+                }
+                else{
+                        replyAdd(reply,"%s\n",shotWord(event.result));
+                }
+        }
+}
+
+/**
+ * @brief Executes a command of a player and formats the answer.
+ *
+ * @param[in,out] session Pointer to the session.
+ * @param[in] line The command, without its end of line.
+ * @param[in] bot Strategy of the bots.
+ * @param[in,out] reply Pointer to the answer.
+ * @return 0 if the session must be closed, 1 otherwise.
+ */
+static int sessionCommand(Session* session, const char* line, Bot_type bot, Reply* reply){
+        if(strcmp(line,"QUITTER") == 0){
+                return 0;
+        }
+        if(session->game == NULL || strcmp(line,"NOUVELLE") == 0){
+                sessionNewGame(session,bot);
+        }
+        Game* game = session->game;
+        int x,y;
+        char end;
+        if(strcmp(line,"NOUVELLE") == 0){
+                replyAdd(reply,"PRET\n");
+                return 1;
+        }
+        if(strcmp(line,"GRILLE") == 0){
+                size_t size = game_config.plate_size;
+                replyReserve(reply,2 * size * (size + 1) + 16);
+                reply->length += renderSymbols(reply->data + reply->length,game->tab_player,0);
+                reply->length += renderSymbols(reply->data + reply->length,game->tab_bot,1);
+        }
+        else if(sscanf(line,"TIR %d %d%c",&x,&y,&end) == 2){
+                if(game->winner >= 0){
+                        replyAdd(reply,"ERREUR partie terminée\n");
+                }
+                else if(x < 0 || y < 0 || x >= game_config.plate_size || y >= game_config.plate_size){
+                        replyAdd(reply,"ERREUR case hors du plateau\n");
+                }
+                else if(!gameInput(game,x,y)){
+                        replyAdd(reply,"ERREUR tir refusé\n");
+                }
+                else{
+                        sessionSteps(game,reply);
+                }
+        }
+        else{
+                replyAdd(reply,"ERREUR commande inconnue\n");
+        }
+        if(game->winner >= 0){
+                replyAdd(reply,game->winner == 0 ? "GAGNE\n" : "PERDU\n");
+                moveLogFlush(game_config.log);
+        }
+        else{
+                replyAdd(reply,"PRET\n");
+        }
+        return 1;
+}
+
+/**
+ * @brief Closes a session and frees it.
+ *
+ * @param[in] epoll_fd The epoll instance of the thread.
+ * @param[in] session Pointer to the session to be closed.
+ */
+static void sessionClose(int epoll_fd, Session* session){
+        epoll_ctl(epoll_fd,EPOLL_CTL_DEL,session->fd,NULL);
+        close(session->fd);
+        gamePoolGive(gamePoolThread(),session->game);
+        free(session->out);
+        free(session);
+        moveLogFlush(game_config.log);
+}
+
+/**
+ * @brief Sends as much as possible of the answer of a session.
+ *
+ * Whatever the socket doesn't take now is kept in the session, which then
+ * waits for the socket to be writable and stops reading commands meanwhile.
+ *
+ * @param[in] epoll_fd The epoll instance of the thread.
+ * @param[in,out] session Pointer to the session.
+ * @param[in] data Characters to send after those already waiting, may be NULL.
+ * @param[in] length Number of characters to send.
+ * @return 0 if the connection is broken, 1 otherwise.
+ */
+static int sessionSend(int epoll_fd, Session* session, const char* data, size_t length){
+        if(session->out != NULL && length > 0){                 //already waiting: keep the order
+                char* out = realloc(session->out,session->out_length + length);
+                if(out == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                memcpy(out + session->out_length,data,length);
+                session->out = out;
+                session->out_length += length;
+                return 1;
+        }
+        if(session->out != NULL){
+                data = session->out;
+                length = session->out_length;
+        }
+        size_t sent = 0;
+        while(sent < length){
+                ssize_t nb = send(session->fd,data + sent,length - sent,MSG_NOSIGNAL);
+                if(nb < 0 && errno == EINTR){
+                        continue;
+                }
+                if(nb < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+                        break;
+                }
+                if(nb <= 0){
+                        return 0;
+                }
+                sent += nb;
+        }
+        int was_waiting = (session->out != NULL);
+        if(sent < length){
+                char* out = malloc(length - sent);
+                if(out == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                memcpy(out,data + sent,length - sent);
+                free(session->out);
+                session->out = out;
+                session->out_length = length - sent;
+        }
+        else{
+                free(session->out);
+                session->out = NULL;
+                session->out_length = 0;
+        }
+        if(was_waiting != (session->out != NULL)){               //switch between waiting for commands and for room in the socket
+                struct epoll_event event = {.events = (session->out != NULL) ? EPOLLOUT : EPOLLIN, .data.ptr = session};
+                epoll_ctl(epoll_fd,EPOLL_CTL_MOD,session->fd,&event);
+        }
+        return 1;
+}
+
+/**
+ * @brief Reads the commands of a session and answers them.
+ *
+ * @param[in] epoll_fd The epoll instance of the thread.
+ * @param[in,out] session Pointer to the session.
+ * @param[in] bot Strategy of the bots.
+ * @param[in,out] reply Answer buffer of the thread.
+ * @return 0 if the session must be closed, 1 otherwise.
+ */
+static int sessionRead(int epoll_fd, Session* session, Bot_type bot, Reply* reply){
+        reply->length = 0;
+        int open = 1;
+        while(open && session->out == NULL){
+                ssize_t nb = recv(session->fd,session->in + session->in_length,SERVER_LINE - session->in_length,0);
+                if(nb < 0 && errno == EINTR){
+                        continue;
+                }
+                if(nb < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+                        break;
+                }
+                if(nb <= 0){
+                        return 0;
+                }
+                session->in_length += nb;
+                int start = 0;
+                for(int i = 0; i < session->in_length && open; i++){
+                        if(session->in[i] != '\n'){
+                                continue;
+                        }
+                        session->in[i] = '\0';
+                        if(i > start && session->in[i - 1] == '\r'){
+                                session->in[i - 1] = '\0';
+                        }
+                        open = sessionCommand(session,session->in + start,bot,reply);
+                        start = i + 1;
+                }
+                session->in_length -= start;
+                memmove(session->in,session->in + start,session->in_length);
+                if(session->in_length == SERVER_LINE){          //a line this long isn't a command
+                        return 0;
+                }
+        }
+        if(reply->length > 0 && sessionSend(epoll_fd,session,reply->data,reply->length) == 0){
+                return 0;
+        }
+        return open;
+}
+
+/**
+ * @brief Accepts every pending connection on a listening socket.
+ *
+ * @param[in] epoll_fd The epoll instance of the thread.
+ * @param[in] listen_fd The listening socket.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+static void serverAccept(int epoll_fd, int listen_fd){
+        while(1){
+                int fd = accept4(listen_fd,NULL,NULL,SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if(fd < 0){                                     //no more pending connection, or too many files open
+                        return;
+                }
+                int one = 1;
+                setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one));
+                Session* session = calloc(1,sizeof(Session));
+                if(session == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                session->fd = fd;
+                struct epoll_event event = {.events = EPOLLIN, .data.ptr = session};
+                if(epoll_ctl(epoll_fd,EPOLL_CTL_ADD,fd,&event) != 0){
+                        close(fd);
+                        free(session);
+                        continue;
+                }
+                char greeting[64];
+                int length = snprintf(greeting,sizeof(greeting),"BATAILLE %d %d\n",game_config.plate_size,game_config.boat_nb);
+                if(sessionSend(epoll_fd,session,greeting,length) == 0){
+                        sessionClose(epoll_fd,session);
+                }
+        }
+}
+
+/**
+ * @brief Opens a non-blocking listening socket on a loopback port.
+ *
+ * @param[in] port The port.
+ * @return The listening socket.
+ *
+ * @note The function exits with an error message if the socket can't be opened.
+ */
+static int serverListen(int port){
+        int fd = socket(AF_INET,SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,0);
+        int one = 1;
+        struct sockaddr_in address;
+        memset(&address,0,sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(fd < 0 || setsockopt(fd,SOL_SOCKET,SO_REUSEADDR,&one,sizeof(one)) != 0 || setsockopt(fd,SOL_SOCKET,SO_REUSEPORT,&one,sizeof(one)) != 0
+           || bind(fd,(struct sockaddr*)&address,sizeof(address)) != 0 || listen(fd,SOMAXCONN) != 0){
+                fprintf(stderr,"Impossible d'écouter sur le port %d",port);
+                exit(6);
+        }
+        return fd;
+}
+
+/**
+ * @brief Runs an event loop: accepts players and serves their sessions, forever.
+ *
+ * @param[in] arg Pointer to the Server_loop of the thread.
+ * @return Never returns.
+ */
+static void* serverLoop(void* arg){
+        Server_loop* loop = arg;
+        int listen_fd = serverListen(loop->port);
+        int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};   //NULL stands for the listening socket
+        if(epoll_fd < 0 || epoll_ctl(epoll_fd,EPOLL_CTL_ADD,listen_fd,&event) != 0){
+                fprintf(stderr,"Erreur lors de la création de la boucle d'évènements");
+                exit(6);
+        }
+        struct epoll_event events[SERVER_EVENTS];
+        Reply reply = {NULL, 0, 0};
+        while(1){
+                int nb = epoll_wait(epoll_fd,events,SERVER_EVENTS,-1);
+                for(int i = 0; i < nb; i++){
+                        Session* session = events[i].data.ptr;
+                        if(session == NULL){
+                                serverAccept(epoll_fd,listen_fd);
+                                continue;
+                        }
+                        int open = 1;
+                        if(events[i].events & EPOLLOUT){
+                                open = sessionSend(epoll_fd,session,NULL,0);
+                        }
+                        if(open && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))){
+                                open = sessionRead(epoll_fd,session,loop->bot,&reply);
+                        }
+                        if(!open){
+                                sessionClose(epoll_fd,session);
+                        }
+                }
+        }
+        return NULL;
+}
+
+/**
+ * @brief Runs the game server on a loopback port until the program is stopped.
+ *
+ * The limit of open files is raised to its maximum so thousands of players can
+ * be connected at the same time.
+ *
+ * @param[in] port Loopback TCP port to listen on.
+ * @param[in] bot Strategy of the bots the players face.
+ * @param[in] nb_threads Number of event-loop threads, one per core (at most 4) if not positive.
+ *
+ * @note The function exits with an error message if the port can't be opened or if a thread can't be created.
+ */
+void runServer(int port, Bot_type bot, int nb_threads){
+        check_const();
+        game_config.mc_threads = 1;                             //the games already run on every core
+        if(bitBoardFits(game_config.plate_size)){                //built before the threads read it, bigger boards use the occupancy grid
+                placementTableInit();
+        }
+        if(nb_threads < 1){
+                nb_threads = sysconf(_SC_NPROCESSORS_ONLN);
+                nb_threads = (nb_threads < 1) ? 1 : (nb_threads > 4) ? 4 : nb_threads;
+        }
+        struct rlimit files;
+        if(getrlimit(RLIMIT_NOFILE,&files) == 0){
+                files.rlim_cur = files.rlim_max;
+                setrlimit(RLIMIT_NOFILE,&files);
+        }
+        Server_loop loop = {port, bot};
+        close(serverListen(port));                              //fails now, not in a thread, if the port is taken
+        printf("Serveur en écoute sur 127.0.0.1:%d (%d threads, bot %s, graine %llu)\n",port,nb_threads,botTypeName(bot),(unsigned long long)game_config.seed);
+        fflush(stdout);
+        for(int i = 1; i < nb_threads; i++){
+                pthread_t thread;
+                if(pthread_create(&thread,NULL,serverLoop,&loop) != 0){
+                        fprintf(stderr,"Erreur lors de la création d'un thread");
+                        exit(1);
+                }
+                pthread_detach(thread);
+        }
+        serverLoop(&loop);
+}
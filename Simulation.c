@@ -0,0 +1,189 @@
+/**
+ * @file Simulation.c
+ * @brief .c file containing the headless bot versus bot simulation engine
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ */
+#include "header.h"
+
+/**
+ * @brief Starts a game between two bots: empties both boards and places both fleets.
+ *
+ * @param[in,out] game Pointer to the game, as returned by createGame.
+ *
+ * @note The function exits with an error message if the game pointer is NULL.
+ */
+void startSimulatedGame(Game* game){
+        if(game == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        uint64_t start = statsClock();
+        gameBoardInit(game->tab_bot);
+        gameBoardInit(game->tab_player);
+        boatPlacement(game->tab_bot,game->boat_tab_bot);
+        boatPlacement(game->tab_player,game->boat_tab_player);
+        statsThread()->placement_ns += statsClock() - start;
+        seatRelease(game);
+        game->turn = 0;
+        game->shots[0] = 0;
+        game->shots[1] = 0;
+        game->winner = -1;
+        game->input = -1;
+}
+
+/**
+ * @brief Plays the shots of a started game between two bots, without any display nor pause.
+ *
+ * Each seat shoots in turn with the same rules as the interactive game: a seat
+ * shoots again as long as it hits a boat. The game stops as soon as one of the
+ * fleets is destroyed, or after max_shots shots so it can be saved and resumed
+ * later; the seat to play and the shots fired are kept in the game. Each seat
+ * plays through the hooks of its strategy (see seatBind), shot after shot with
+ * gameShot: this is gameStep without its checks, BOT_HUMAN asking its cases on
+ * the standard input.
+ *
+ * @param[in,out] game Pointer to the game, started by startSimulatedGame or loaded from a snapshot.
+ * @param[in] bot_player Strategy of the player seat (seat 0).
+ * @param[in] bot_ennemy Strategy of the bot seat (seat 1).
+ * @param[in] max_shots Number of shots after which the function returns, no limit if negative.
+ * @return 1 if the game is over, game->winner holding the winning seat, 0 otherwise.
+ *
+ * @note The function exits with an error message if the game pointer is NULL.
+ */
+int resumeSimulatedGame(Game* game, Bot_type bot_player, Bot_type bot_ennemy, long max_shots){
+        if(game == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        seatBind(game,0,bot_player);
+        seatBind(game,1,bot_ennemy);
+        Game_event event;
+        uint64_t start = statsClock();
+        for(long shot = 0; game->winner < 0 && shot != max_shots; shot++){
+                gameShot(game,&event);
+        }
+        statsThread()->play_ns += statsClock() - start;
+        if(game->winner >= 0){
+                statsGame(game->shots[0] + game->shots[1]);
+        }
+        return game->winner >= 0;
+}
+
+/**
+ * @brief Plays a full game between two bots on a created game, without any display nor pause.
+ *
+ * The function starts the game with startSimulatedGame and plays it to the end
+ * with resumeSimulatedGame.
+ *
+ * Every random draw comes from the generator of the game, so the same seed
+ * always gives the same game (except with the Monte Carlo bot, whose decisions
+ * depend on its time budget), and games can be played at the same time on
+ * different threads.
+ *
+ * @param[in,out] game Pointer to the game, as returned by createGame.
+ * @param[in] bot_player Strategy of the player seat (seat 0).
+ * @param[in] bot_ennemy Strategy of the bot seat (seat 1).
+ * @return The winning seat and the number of missiles fired by each seat.
+ *
+ * @note The function exits with an error message if the game pointer is NULL.
+ */
+Sim_result playSimulatedGame(Game* game, Bot_type bot_player, Bot_type bot_ennemy){
+        startSimulatedGame(game);
+        resumeSimulatedGame(game,bot_player,bot_ennemy,-1);
+        Sim_result result = {game->winner, {game->shots[0], game->shots[1]}};
+        return result;
+}
+
+/**
+ * @brief Plays a full game between two bots without any display nor pause.
+ *
+ * @param[in] bot_player Strategy of the player seat (seat 0).
+ * @param[in] bot_ennemy Strategy of the bot seat (seat 1).
+ * @param[in] seed Seed of the random generator of the game.
+ * @return The winning seat and the number of missiles fired by each seat.
+ *
+ * The game is taken from the pool of the calling thread and given back at the
+ * end, so a thread simulating game after game doesn't allocate any memory.
+ *
+ * @note The function exits with an error message if memory allocation fails during game creation.
+ */
+Sim_result simulateGame(Bot_type bot_player, Bot_type bot_ennemy, uint64_t seed){
+        Game_pool* pool = gamePoolThread();                             //reuses the memory of the previous game of the thread
+        Game* game = gamePoolTake(pool,seed);
+        Sim_result result = playSimulatedGame(game,bot_player,bot_ennemy);
+        gamePoolGive(pool,game);
+        return result;
+}
+
+/**
+ * @brief Replays alone one game of a simulation run and displays it.
+ *
+ * The n-th game of a run started with a given seed always uses the generator
+ * seeded with rngStreamSeed(seed, n), so it is played again exactly, then the
+ * final boards and the result are displayed.
+ *
+ * @param[in] seed Seed of the run, as displayed by runSimulation or runTournament.
+ * @param[in] index Number of the game in the run.
+ * @param[in] bot_player Strategy of the player seat.
+ * @param[in] bot_ennemy Strategy of the bot seat.
+ */
+void replayGame(uint64_t seed, long index, Bot_type bot_player, Bot_type bot_ennemy){
+        check_const();
+        struct timespec start, end;
+        Game* game = createGame(rngStreamSeed(seed,index));
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        Sim_result result = playSimulatedGame(game,bot_player,bot_ennemy);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        char player_title[64], ennemy_title[64];
+        snprintf(player_title,sizeof(player_title)," --- JOUEUR (%s) ---",botTypeName(bot_player));
+        snprintf(ennemy_title,sizeof(ennemy_title)," --- BOT (%s) ---",botTypeName(bot_ennemy));
+        Game_board* boards[2] = {game->tab_player, game->tab_bot};
+        const int hidden[2] = {0, 0};
+        const char* titles[2] = {player_title, ennemy_title};
+        game->renderer = rendererCreate(game_config.plate_size,0);
+        renderBoards(game->renderer,boards,hidden,titles);
+        printf("Partie %ld de la graine %llu: victoire du %s en %d tirs (%d tirs adverses), %.3f ms\n",index,(unsigned long long)seed,result.winner == 0 ? "joueur" : "bot",result.shots[result.winner],result.shots[1 - result.winner],
+               (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6);
+        freeGame(game);
+}
+
+/**
+ * @brief Runs a batch of headless games and reports the throughput.
+ *
+ * The function plays the requested number of simulated games, then displays the
+ * win rate of each seat, the average number of shots and the number of games per second.
+ *
+ * @param[in] nb_games Number of games to simulate.
+ * @param[in] bot_player Strategy of the player seat.
+ * @param[in] bot_ennemy Strategy of the bot seat.
+ * @param[in] seed Seed of the run, game i being played with rngStreamSeed(seed, i).
+ *
+ * @note The function exits with an error message if the number of games is not positive.
+ */
+void runSimulation(long nb_games, Bot_type bot_player, Bot_type bot_ennemy, uint64_t seed){
+        if(nb_games < 1){
+                fprintf(stderr,"Nombre de parties invalide");
+                exit(2);
+        }
+        check_const();
+        long wins[2] = {0, 0};
+        long shots = 0;
+        long win_shots[2] = {0, 0};
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        for(long i = 0; i < nb_games; i++){
+                Sim_result result = simulateGame(bot_player,bot_ennemy,rngStreamSeed(seed,i));
+                wins[result.winner]++;
+                shots += result.shots[0] + result.shots[1];
+                win_shots[result.winner] += result.shots[result.winner];
+        }
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        printf("%ld parties simulées en %.3f s (graine %llu)\n",nb_games,elapsed,(unsigned long long)seed);
+        printf("Victoires: joueur %ld (%.2f%%) - bot %ld (%.2f%%)\n",wins[0],100.0 * wins[0] / nb_games,wins[1],100.0 * wins[1] / nb_games);
+        printf("Tirs moyens par partie: %.2f\n",(double)shots / nb_games);
+        printf("Tirs moyens par partie gagnée: joueur %.2f - bot %.2f\n",wins[0] ? (double)win_shots[0] / wins[0] : 0.0,wins[1] ? (double)win_shots[1] / wins[1] : 0.0);
+        printf("Débit: %.0f parties/s\n",nb_games / elapsed);
+}
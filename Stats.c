@@ -0,0 +1,237 @@
+/**
+ * @file Stats.c
+ * @brief .c file containing the counters of the hot paths of the engine
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * The counters watch the loops that could degenerate: the placement retries
+ * and restarts of a fleet, the moves of the random bot, the shots of each game
+ * and the time spent drawing fleets, placing them and playing. Each thread counts in its own
+ * Stats, without any lock nor atomic operation, and the hot loops count in a
+ * local variable first and add it once per fleet, move or game, so the
+ * counters stay enabled all the time. A thread adds its counters to the totals
+ * of the run when it ends, once statsThread registered it; every game calls it
+ * when it draws its fleets, so the random bot, called once per move, counts in
+ * thread_stats directly without the call.
+ *
+ * With --stats <file>, the totals are written when the program ends: in JSON
+ * if the name of the file ends with ".json", in the Prometheus text format
+ * otherwise.
+ */
+#include "header.h"
+#include <stddef.h>
+
+/**
+ * @brief Structure describing a counter, to write every counter the same way.
+ */
+typedef struct{
+        const char* name;     /**< Name of the counter. */
+        size_t offset;        /**< Position of the counter in Stats. */
+        int is_max;           /**< 1 for a maximum, 0 for a sum. */
+        int is_time;          /**< 1 for a duration in nanoseconds, written in seconds. */
+        const char* help;     /**< Meaning of the counter. */
+}Stats_counter;
+
+static const Stats_counter stats_counters[] = {
+        {"games", offsetof(Stats,games), 0, 0, "Parties jouées jusqu'à leur fin."},
+        {"shots", offsetof(Stats,shots), 0, 0, "Tirs des parties finies."},
+        {"shots_per_game_max", offsetof(Stats,shots_max), 1, 0, "Plus grand nombre de tirs d'une partie."},
+        {"fleets", offsetof(Stats,fleets), 0, 0, "Flottes tirées."},
+        {"placement_retries", offsetof(Stats,placement_retries), 0, 0, "Bateaux tirés à nouveau car ils chevauchaient la flotte."},
+        {"fleet_restarts", offsetof(Stats,fleet_restarts), 0, 0, "Flottes recommencées faute de place pour un bateau."},
+        {"random_moves", offsetof(Stats,random_moves), 0, 0, "Cases choisies par le bot aléatoire."},
+        {"fleet_seconds", offsetof(Stats,fleet_ns), 0, 1, "Temps passé à tirer les flottes."},
+        {"placement_seconds", offsetof(Stats,placement_ns), 0, 1, "Temps passé à vider les plateaux et y placer les flottes."},
+        {"play_seconds", offsetof(Stats,play_ns), 0, 1, "Temps passé à jouer les tirs des bots."},
+};
+
+#define STATS_NB (sizeof(stats_counters) / sizeof(stats_counters[0]))   /**< Number of counters. */
+
+static Stats stats_total;                                /**< Counters of the threads that ended. */
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t stats_key;                          /**< Adds the counters of a thread to the totals when it ends. */
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+__thread Stats thread_stats;                             /**< Counters of the thread, written directly by the hottest loops. */
+static __thread int thread_registered = 0;               /**< 1 once the counters of the thread are added to the totals when it ends. */
+static const char* stats_path = NULL;                    /**< File written when the program ends, NULL without --stats. */
+
+/**
+ * @brief Gives a counter of a Stats structure.
+ *
+ * @param[in] stats Pointer to the counters.
+ * @param[in] counter Description of the counter.
+ * @return A pointer to the counter.
+ */
+static uint64_t* statsField(Stats* stats, const Stats_counter* counter){
+        return (uint64_t*)((char*)stats + counter->offset);
+}
+
+/**
+ * @brief Adds counters to others, sums added and maximums kept.
+ *
+ * @param[in,out] total The counters added to.
+ * @param[in] stats The counters to add.
+ */
+static void statsMerge(Stats* total, Stats* stats){
+        for(size_t i = 0; i < STATS_NB; i++){
+                uint64_t* to = statsField(total,&stats_counters[i]);
+                uint64_t value = *statsField(stats,&stats_counters[i]);
+                if(stats_counters[i].is_max){
+                        *to = (value > *to) ? value : *to;
+                }
+                else{
+                        *to += value;
+                }
+        }
+}
+
+/**
+ * @brief Adds the counters of a thread that ends to the totals.
+ *
+ * @param[in] stats Pointer to the counters of the thread.
+ */
+static void statsThreadEnd(void* stats){
+        pthread_mutex_lock(&stats_lock);
+        statsMerge(&stats_total,stats);
+        pthread_mutex_unlock(&stats_lock);
+}
+
+/**
+ * @brief Creates the key adding the counters of each thread to the totals.
+ */
+static void statsKeyInit(){
+        pthread_key_create(&stats_key,statsThreadEnd);
+}
+
+/**
+ * @brief Gives the counters of the calling thread.
+ *
+ * @return A pointer to the counters of the thread, only written by this thread.
+ */
+Stats* statsThread(){
+        if(!thread_registered){
+                pthread_once(&stats_once,statsKeyInit);
+                pthread_setspecific(stats_key,&thread_stats);
+                thread_registered = 1;
+        }
+        return &thread_stats;
+}
+
+/**
+ * @brief Gives the current time of the monotonic clock, to time the phases.
+ *
+ * @return The time, in nanoseconds.
+ */
+uint64_t statsClock(){
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC,&now);
+        return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+/**
+ * @brief Counts a finished game.
+ *
+ * @param[in] shots Number of shots of the game, both seats together.
+ */
+void statsGame(int shots){
+        Stats* stats = statsThread();
+        stats->games++;
+        stats->shots += shots;
+        if((uint64_t)shots > stats->shots_max){
+                stats->shots_max = shots;
+        }
+}
+
+/**
+ * @brief Gives the counters of the run: those of the threads that ended and those of the calling thread.
+ *
+ * @param[out] stats The counters of the run.
+ */
+void statsCollect(Stats* stats){
+        memset(stats,0,sizeof(*stats));
+        pthread_mutex_lock(&stats_lock);
+        statsMerge(stats,&stats_total);
+        pthread_mutex_unlock(&stats_lock);
+        statsMerge(stats,&thread_stats);
+}
+
+/**
+ * @brief Writes counters in JSON.
+ *
+ * @param[in] stats The counters.
+ * @param[in] file The file to write to.
+ */
+static void statsWriteJson(Stats* stats, FILE* file){
+        fprintf(file,"{\n");
+        for(size_t i = 0; i < STATS_NB; i++){
+                uint64_t value = *statsField(stats,&stats_counters[i]);
+                if(stats_counters[i].is_time){
+                        fprintf(file,"  \"%s\": %.9f,\n",stats_counters[i].name,value / 1e9);
+                }
+                else{
+                        fprintf(file,"  \"%s\": %llu,\n",stats_counters[i].name,(unsigned long long)value);
+                }
+        }
+        fprintf(file,"  \"shots_per_game\": %.3f,\n",stats->games ? (double)stats->shots / stats->games : 0.0);
+        fprintf(file,"  \"placement_retries_per_fleet\": %.3f\n",stats->fleets ? (double)stats->placement_retries / stats->fleets : 0.0);
+        fprintf(file,"}\n");
+}
+
+/**
+ * @brief Writes counters in the Prometheus text format.
+ *
+ * The sums are counters, suffixed with _total, and the maximums are gauges.
+ *
+ * @param[in] stats The counters.
+ * @param[in] file The file to write to.
+ */
+static void statsWritePrometheus(Stats* stats, FILE* file){
+        for(size_t i = 0; i < STATS_NB; i++){
+                const Stats_counter* counter = &stats_counters[i];
+                uint64_t value = *statsField(stats,counter);
+                const char* suffix = counter->is_max ? "" : "_total";
+                fprintf(file,"# HELP bataille_%s%s %s\n",counter->name,suffix,counter->help);
+                fprintf(file,"# TYPE bataille_%s%s %s\n",counter->name,suffix,counter->is_max ? "gauge" : "counter");
+                if(counter->is_time){
+                        fprintf(file,"bataille_%s%s %.9f\n",counter->name,suffix,value / 1e9);
+                }
+                else{
+                        fprintf(file,"bataille_%s%s %llu\n",counter->name,suffix,(unsigned long long)value);
+                }
+        }
+}
+
+/**
+ * @brief Writes the counters of the run in the file of --stats.
+ *
+ * @note The function displays an error message if the file can't be written; the program is already ending.
+ */
+static void statsDump(){
+        Stats stats;
+        statsCollect(&stats);
+        FILE* file = fopen(stats_path,"w");
+        if(file == NULL){
+                fprintf(stderr,"Impossible d'écrire les statistiques dans %s",stats_path);
+                return;
+        }
+        size_t length = strlen(stats_path);
+        if(length >= 5 && strcmp(stats_path + length - 5,".json") == 0){
+                statsWriteJson(&stats,file);
+        }
+        else{
+                statsWritePrometheus(&stats,file);
+        }
+        fclose(file);
+}
+
+/**
+ * @brief Writes the counters of the run in a file when the program ends.
+ *
+ * @param[in] path Path of the file, written in JSON if it ends with ".json" and in the Prometheus text format otherwise.
+ */
+void statsOpen(const char* path){
+        if(stats_path == NULL){
+                atexit(statsDump);
+        }
+        stats_path = path;
+}
@@ -0,0 +1,288 @@
+/**
+ * @file Strategy.c
+ * @brief .c file containing the strategies of the seats and their registry
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * A strategy is a table of hooks (see Strategy): every mode plays a seat through
+ * the hooks of the strategy bound to it, with the state of the seat kept in the
+ * game. A new strategy is a new table added to the registry, the game loops
+ * don't change: it can then be named on the command line of every mode.
+ */
+#include "header.h"
+
+/**
+ * @brief Chooses a random case not shot yet (see botTarget).
+ */
+static void randomChoose(void* state, Game_board* board, Boat* boat_list, int* x, int* y, Rng* rng){
+        (void)state;
+        (void)boat_list;
+        botTarget(board,x,y,rng);
+}
+
+/**
+ * @brief Chooses the case covered by the most placements of the remaining boats (see densityTarget).
+ */
+static void densityChoose(void* state, Game_board* board, Boat* boat_list, int* x, int* y, Rng* rng){
+        (void)state;
+        densityTarget(board,boat_list,x,y,rng);
+}
+
+/**
+ * @brief Structure representing the state of a Monte Carlo seat.
+ */
+typedef struct{
+        int node;             /**< Position of the game in the opening book, negative once out of it. */
+        Mc_sampler* sampler;  /**< Sampling threads of the seat, kept from one decision to the next. */
+}Monte_carlo_state;
+
+/**
+ * @brief Starts a Monte Carlo seat at the root of the opening book, with the threads sampling for it (game_config.mc_threads).
+ */
+static void monteCarloInit(void* state, Game_board* board, Boat* boat_list){
+        (void)board;
+        (void)boat_list;
+        Monte_carlo_state* seat = state;
+        seat->node = 0;
+        seat->sampler = monteCarloSamplerCreate(game_config.mc_threads);
+}
+
+/**
+ * @brief Chooses the case occupied in the most sampled layouts, in MC_BUDGET_MS milliseconds (see monteCarloTarget).
+ *
+ * With --book, the first shots come from the opening book instead, as long as
+ * the game stays in it.
+ */
+static void monteCarloChoose(void* state, Game_board* board, Boat* boat_list, int* x, int* y, Rng* rng){
+        Monte_carlo_state* seat = state;
+        int cell = bookShot(game_config.book,board,seat->node);
+        if(cell >= 0){
+                *x = cell % board->Matrix_size;
+                *y = cell / board->Matrix_size;
+                return;
+        }
+        monteCarloTarget(board,boat_list,x,y,MC_BUDGET_MS,seat->sampler,rng);
+}
+
+/**
+ * @brief Follows the result of the shot in the opening book.
+ */
+static void monteCarloObserve(void* state, Game_board* board, int x, int y, Shot_result result, int boat_id){
+        (void)board;
+        (void)x;
+        (void)y;
+        (void)boat_id;
+        Monte_carlo_state* seat = state;
+        seat->node = bookFollow(game_config.book,seat->node,result);
+}
+
+/**
+ * @brief Stops the sampling threads of a Monte Carlo seat.
+ */
+static void monteCarloReset(void* state){
+        Monte_carlo_state* seat = state;
+        monteCarloSamplerFree(seat->sampler);
+        seat->sampler = NULL;
+}
+
+/**
+ * @brief Hunts on one colour of a checkerboard and finishes the boats it hit.
+ *
+ * As long as a boat is hit but not sunk, the bot shoots the first case (row after
+ * row) not shot yet next to one of its wrecks. Otherwise it shoots a random case
+ * not shot yet among those where x + y is even, which every boat of two cases or
+ * more covers, and a random case not shot yet once they are all shot. The batch
+ * engine plays the same bot on its bitboards (see Batch.c).
+ */
+static void parityChoose(void* state, Game_board* board, Boat* boat_list, int* x, int* y, Rng* rng){
+        (void)state;
+        (void)boat_list;
+        int n = board->Matrix_size;
+        for(int i = 0; i < n * n; i++){                         //target: next to a wreck of a boat still afloat
+                Case_type type = board->cells[i];
+                if(type == WATER_SHOT || type == WRECK){
+                        continue;
+                }
+                int cx = i % n, cy = i / n;
+                const int neighbours[4][2] = {{cx - 1, cy}, {cx + 1, cy}, {cx, cy - 1}, {cx, cy + 1}};
+                for(int k = 0; k < 4; k++){
+                        int nx = neighbours[k][0], ny = neighbours[k][1];
+                        if(nx >= 0 && ny >= 0 && nx < n && ny < n && board->cells[ny * n + nx] == WRECK && board->hits_left[board->boat_ids[ny * n + nx]] > 0){
+                                *x = cx;
+                                *y = cy;
+                                return;
+                        }
+                }
+        }
+        int nb_even = 0;
+        for(int i = 0; i < board->nb_unshot; i++){              //hunt: a random case of the even colour not shot yet
+                int cell = board->unshot[i];
+                nb_even += (cell % n + cell / n) % 2 == 0;
+        }
+        if(nb_even == 0){
+                botTarget(board,x,y,rng);
+                return;
+        }
+        int k = rngBounded(rng,nb_even);
+        for(int i = 0; i < board->nb_unshot; i++){
+                int cell = board->unshot[i];
+                if((cell % n + cell / n) % 2 == 0 && k-- == 0){
+                        *x = cell % n;
+                        *y = cell / n;
+                        return;
+                }
+        }
+}
+
+/**
+ * @brief Asks the coordinates of the shot on the standard input (see getMissile_X and getMissile_Y).
+ *
+ * The game loops stepped with gameStep don't block on it: they wait for the case
+ * given by gameInput and call it only when they may block.
+ */
+static void humanChoose(void* state, Game_board* board, Boat* boat_list, int* x, int* y, Rng* rng){
+        (void)state;
+        (void)board;
+        (void)boat_list;
+        (void)rng;
+        *x = getMissile_X();
+        *y = getMissile_Y();
+}
+
+const Strategy strategy_random = {"random",0,NULL,randomChoose,NULL,NULL,0};
+const Strategy strategy_density = {"density",0,NULL,densityChoose,NULL,NULL,0};
+const Strategy strategy_monte_carlo = {"montecarlo",sizeof(Monte_carlo_state),monteCarloInit,monteCarloChoose,monteCarloObserve,monteCarloReset,0};
+const Strategy strategy_parity = {"parity",0,NULL,parityChoose,NULL,NULL,0};
+const Strategy strategy_human = {"human",0,NULL,humanChoose,NULL,NULL,1};    //its cases come from gameInput when a driver steps the game
+
+/**
+ * @brief Registry of the strategies, looked up by name.
+ */
+static const Strategy* const strategy_registry[] = {
+        &strategy_random,
+        &strategy_density,
+        &strategy_monte_carlo,
+        &strategy_parity,
+        &strategy_human
+};
+
+#define STRATEGY_COUNT ((int)(sizeof(strategy_registry) / sizeof(strategy_registry[0])))
+
+/**
+ * @brief Finds a strategy of the registry by its name.
+ *
+ * @param[in] name Name of the strategy ("random", "density", "montecarlo", "parity" or "human").
+ * @return The corresponding strategy.
+ *
+ * @note The function exits with an error message listing the strategies if the name is unknown.
+ */
+Bot_type botTypeFromName(const char* name){
+        for(int i = 0; name != NULL && i < STRATEGY_COUNT; i++){
+                if(strcmp(name,strategy_registry[i]->name) == 0){
+                        return strategy_registry[i];
+                }
+        }
+        fprintf(stderr,"Stratégie inconnue: %s (",name == NULL ? "(null)" : name);
+        for(int i = 0; i < STRATEGY_COUNT; i++){
+                fprintf(stderr,"%s%s",i ? ", " : "",strategy_registry[i]->name);
+        }
+        fprintf(stderr,")");
+        exit(2);
+}
+
+/**
+ * @brief Gives the name of a strategy.
+ *
+ * @param[in] bot The strategy.
+ * @return The name accepted by botTypeFromName.
+ */
+const char* botTypeName(Bot_type bot){
+        return bot->name;
+}
+
+/**
+ * @brief Binds a strategy to a seat of a game, which starts with a cleared state.
+ *
+ * Nothing changes if the seat already plays with this strategy, so a game can be
+ * resumed with the state its seats had. Otherwise the previous strategy of the
+ * seat is reset and the init hook of the new one is called on the board targeted
+ * by the seat (the bot board for seat 0, the player board for seat 1).
+ *
+ * @param[in,out] game Pointer to the game.
+ * @param[in] seat Seat to bind, 0 or 1.
+ * @param[in] bot Strategy of the seat.
+ *
+ * @note The function exits with an error message if a parameter is invalid or if the state of the strategy doesn't fit in a seat.
+ */
+void seatBind(Game* game, int seat, Bot_type bot){
+        if(game == NULL || bot == NULL || bot->choose == NULL || (seat != 0 && seat != 1) || bot->state_size > STRATEGY_STATE_SIZE){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Seat* place = &game->seats[seat];
+        if(place->strategy == bot){
+                return;
+        }
+        if(place->strategy != NULL && place->strategy->reset != NULL){
+                place->strategy->reset(place->state);
+        }
+        place->strategy = bot;
+        memset(place->state,0,sizeof(place->state));
+        if(bot->init != NULL){
+                bot->init(place->state,seat == 0 ? game->tab_bot : game->tab_player,seat == 0 ? game->boat_tab_bot : game->boat_tab_player);
+        }
+}
+
+/**
+ * @brief Resets the strategies of both seats of a game and leaves the seats unbound.
+ *
+ * It is called whenever a game starts again or is freed, so a strategy can free
+ * what its init hook allocated.
+ *
+ * @param[in,out] game Pointer to the game.
+ */
+void seatRelease(Game* game){
+        for(int seat = 0; seat < 2; seat++){
+                Seat* place = &game->seats[seat];
+                if(place->strategy != NULL && place->strategy->reset != NULL){
+                        place->strategy->reset(place->state);
+                }
+                place->strategy = NULL;
+        }
+}
+
+/**
+ * @brief Chooses the case shot by a seat with its strategy, without modifying the board.
+ *
+ * @param[in,out] game Pointer to the game, whose seat was bound with seatBind.
+ * @param[in] seat Seat to play, 0 or 1.
+ * @param[out] x X-coordinate chosen.
+ * @param[out] y Y-coordinate chosen.
+ *
+ * @note The function exits with an error message if the seat is not bound.
+ */
+void seatChoose(Game* game, int seat, int* x, int* y){
+        if(game == NULL || (seat != 0 && seat != 1) || game->seats[seat].strategy == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        Seat* place = &game->seats[seat];
+        place->strategy->choose(place->state,seat == 0 ? game->tab_bot : game->tab_player,seat == 0 ? game->boat_tab_bot : game->boat_tab_player,x,y,&game->rng);
+}
+
+/**
+ * @brief Gives the result of its shot to the strategy of a seat, if it has an observe hook.
+ *
+ * @param[in,out] game Pointer to the game, whose seat was bound with seatBind.
+ * @param[in] seat Seat which shot, 0 or 1.
+ * @param[in] x X-coordinate of the shot.
+ * @param[in] y Y-coordinate of the shot.
+ * @param[in] result Result of the shot.
+ * @param[in] boat_id Index in the fleet of the boat hit, -1 if no boat was hit.
+ */
+void seatObserve(Game* game, int seat, int x, int y, Shot_result result, int boat_id){
+        Seat* place = &game->seats[seat];
+        if(place->strategy != NULL && place->strategy->observe != NULL){
+                place->strategy->observe(place->state,seat == 0 ? game->tab_bot : game->tab_player,x,y,result,boat_id);
+        }
+}
@@ -0,0 +1,169 @@
+/**
+ * @file Tournament.c
+ * @brief .c file containing the parallel round-robin tournament between bots
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * Every pair of strategies plays the same number of games, half of them with
+ * each strategy on the first seat. The games are cut into chunks of
+ * TOURNAMENT_CHUNK games executed by the work-stealing pool; each chunk writes
+ * its own counters, which are only added together once every chunk is done.
+ */
+#include "header.h"
+
+/**
+ * @brief Structure representing a chunk of games between two strategies.
+ */
+typedef struct{
+        int first;            /**< Index of the strategy on seat 0. */
+        int second;           /**< Index of the strategy on seat 1. */
+        Bot_type bot_types[2];/**< Strategy of each seat. */
+        long nb_games;        /**< Number of games of the chunk. */
+        uint64_t seed;        /**< Seed of the tournament. */
+        long first_game;      /**< Number of the first game of the chunk in the tournament. */
+        long wins[2];         /**< Games won by each seat. */
+        long win_shots[2];    /**< Shots fired by each seat in the games it won. */
+}Tournament_task;
+
+/**
+ * @brief Plays the games of a chunk.
+ *
+ * @param[in,out] arg Pointer to the Tournament_task to execute.
+ */
+static void tournamentChunk(void* arg){
+        Tournament_task* task = arg;
+        for(long i = 0; i < task->nb_games; i++){
+                Sim_result result = simulateGame(task->bot_types[0],task->bot_types[1],rngStreamSeed(task->seed,task->first_game + i));
+                task->wins[result.winner]++;
+                task->win_shots[result.winner] += result.shots[result.winner];
+        }
+        moveLogFlush(game_config.log);                          //the worker may not play any other chunk
+}
+
+/**
+ * @brief Computes the 95% Wilson confidence interval of a win rate.
+ *
+ * @param[in] wins Number of games won.
+ * @param[in] games Number of games played, must be positive.
+ * @param[out] low Lower bound of the interval.
+ * @param[out] high Upper bound of the interval.
+ */
+void wilsonInterval(long wins, long games, double* low, double* high){
+        double z = 1.96;
+        double p = (double)wins / games;
+        double denominator = 1 + z * z / games;
+        double center = (p + z * z / (2.0 * games)) / denominator;
+        double half = z * sqrt(p * (1 - p) / games + z * z / (4.0 * games * games)) / denominator;
+        *low = center - half;
+        *high = center + half;
+}
+
+/**
+ * @brief Plays a round-robin tournament between bots on every core and displays the results.
+ *
+ * Every pair of strategies plays nb_games games. For each pair the function
+ * displays the win rate of each strategy with its 95% confidence interval and the
+ * average number of shots it needed to win, then the overall win rate of each
+ * strategy and the number of games per second.
+ *
+ * @param[in] nb_games Number of games played by each pair of strategies.
+ * @param[in] bots Array of the strategies taking part.
+ * @param[in] nb_bots Number of strategies, at least 2.
+ * @param[in] nb_threads Number of threads, one per core if not positive.
+ * @param[in] seed Seed of the tournament, game n being played with rngStreamSeed(seed, n).
+ *
+ * @note The function exits with an error message if the parameters are invalid or if memory allocation fails.
+ */
+void runTournament(long nb_games, Bot_type* bots, int nb_bots, int nb_threads, uint64_t seed){
+        if(nb_games < 2 || bots == NULL || nb_bots < 2){
+                fprintf(stderr,"Paramètres du tournoi invalides");
+                exit(2);
+        }
+        check_const();
+        game_config.mc_threads = 1;                             //the games already run on every core
+        if(bitBoardFits(game_config.plate_size)){                //built before the threads read it, bigger boards use the occupancy grid
+                placementTableInit();
+        }
+        long chunks_per_seat = (nb_games - nb_games / 2 + TOURNAMENT_CHUNK - 1) / TOURNAMENT_CHUNK;
+        int nb_pairs = nb_bots * (nb_bots - 1) / 2;
+        long nb_tasks = nb_pairs * 2 * chunks_per_seat;
+        Tournament_task* tasks = calloc(nb_tasks,sizeof(Tournament_task));
+        if(tasks == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        Thread_pool* pool = poolCreate(nb_threads);
+        long first_game = 0;
+        long t = 0;
+        for(int a = 0; a < nb_bots; a++){
+                for(int b = a + 1; b < nb_bots; b++){
+                        for(int side = 0; side < 2; side++){    //half of the games with each strategy on the first seat
+                                long games_left = (side == 0) ? nb_games / 2 : nb_games - nb_games / 2;
+                                for(long c = 0; c < chunks_per_seat; c++){
+                                        tasks[t].first = (side == 0) ? a : b;
+                                        tasks[t].second = (side == 0) ? b : a;
+                                        tasks[t].bot_types[0] = bots[tasks[t].first];
+                                        tasks[t].bot_types[1] = bots[tasks[t].second];
+                                        tasks[t].nb_games = (games_left < TOURNAMENT_CHUNK) ? games_left : TOURNAMENT_CHUNK;
+                                        tasks[t].seed = seed;
+                                        tasks[t].first_game = first_game;
+                                        first_game += tasks[t].nb_games;
+                                        games_left -= tasks[t].nb_games;
+                                        poolSubmit(pool,tournamentChunk,&tasks[t]);
+                                        t++;
+                                }
+                        }
+                }
+        }
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        poolRun(pool);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        long* total_wins = calloc(nb_bots,sizeof(long));
+        long* total_games = calloc(nb_bots,sizeof(long));
+        if(total_wins == NULL || total_games == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        long played = 0;
+        double low, high;
+        printf("--- TOURNOI: %d stratégies, %d threads, graine %llu ---\n",nb_bots,pool->nb_workers,(unsigned long long)seed);
+        t = 0;
+        for(int a = 0; a < nb_bots; a++){
+                for(int b = a + 1; b < nb_bots; b++){
+                        long games = 0, wins[2] = {0, 0}, win_shots[2] = {0, 0};
+                        for(long k = 0; k < 2 * chunks_per_seat; k++, t++){     //add the counters of the chunks of the pair
+                                int seat_a = (tasks[t].first == a) ? 0 : 1;
+                                games += tasks[t].nb_games;
+                                wins[0] += tasks[t].wins[seat_a];
+                                wins[1] += tasks[t].wins[1 - seat_a];
+                                win_shots[0] += tasks[t].win_shots[seat_a];
+                                win_shots[1] += tasks[t].win_shots[1 - seat_a];
+                        }
+                        played += games;
+                        total_wins[a] += wins[0];
+                        total_wins[b] += wins[1];
+                        total_games[a] += games;
+                        total_games[b] += games;
+                        wilsonInterval(wins[0],games,&low,&high);
+                        printf("%s contre %s: %ld parties\n",botTypeName(bots[a]),botTypeName(bots[b]),games);
+                        printf("   %s gagne %.2f%% [%.2f%% ; %.2f%%], %.2f tirs par victoire\n",botTypeName(bots[a]),100.0 * wins[0] / games,100 * low,100 * high,wins[0] ? (double)win_shots[0] / wins[0] : 0.0);
+                        wilsonInterval(wins[1],games,&low,&high);
+                        printf("   %s gagne %.2f%% [%.2f%% ; %.2f%%], %.2f tirs par victoire\n",botTypeName(bots[b]),100.0 * wins[1] / games,100 * low,100 * high,wins[1] ? (double)win_shots[1] / wins[1] : 0.0);
+                }
+        }
+        printf("--- CLASSEMENT ---\n");
+        for(int a = 0; a < nb_bots; a++){
+                wilsonInterval(total_wins[a],total_games[a],&low,&high);
+                printf("%s: %.2f%% de victoires [%.2f%% ; %.2f%%] sur %ld parties\n",botTypeName(bots[a]),100.0 * total_wins[a] / total_games[a],100 * low,100 * high,total_games[a]);
+        }
+        printf("%ld parties en %.3f s (%.0f parties/s)\n",played,elapsed,played / elapsed);
+
+        free(total_wins);
+        free(total_games);
+        free(tasks);
+        poolFree(pool);
+}
@@ -8,139 +8,220 @@
 #include "header.h"
 
 /**
- * @brief Processes a missile shoot at the specified coordinates on the game board.
+ * @brief Resolves a missile shoot at the given coordinates without any display.
  *
- * The function prompts the user for missile coordinates, checks the result of the shoot,
- * and updates the game board accordingly.
+ * The function checks what lies on the targeted case and updates the game board
+ * accordingly. It is the headless core shared by the interactive shoots and the
+ * simulation engine. A hit decrements the intact cases of the boat found in the
+ * boat index of the board, and the number of boats alive when it was the last one.
+ * The shot is recorded in the move log of the board, if any.
  *
  * @param[in,out] board Pointer to the game board structure.
- * @return 0 if the shoot was unsuccessful, 1 if a boat was hit, and updates the board.
+ * @param[in] x X-coordinate of the targeted case.
+ * @param[in] y Y-coordinate of the targeted case.
+ * @param[out] boat_id Index in the fleet of the boat hit, may be NULL; left untouched if no boat was hit.
+ * @return SHOT_MISS if the missile fell into the water, SHOT_HIT if a boat was hit,
+ * SHOT_SUNK if it was its last intact case, SHOT_ALREADY if the case had already been shot.
  *
  * @note The function exits with an error message if the game board pointer is NULL.
  */
-int missileShoot(Game_board* board){
+Shot_result resolveShot(Game_board* board, int x, int y, int* boat_id){
         if (board == NULL){
                 fprintf(stderr,"Erreur de paramètre");
                 exit(2);
-        } 
-        int x = getMissile_X();
-        int y = getMissile_Y();
-        if (board->matrix[y][x] == WATER){
-                printf("Raté, le tir est partit droit dans l'eau !\n");
-                board->matrix[y][x] = WATER_SHOT;
-                return 0;
         }
-        else if(board->matrix[y][x] == WATER_SHOT || board->matrix[y][x] == WRECK){
-                printf("Vous avez deja tiré ici chef !\n");
-                return 0;
+        if(bitBoardFits(board->Matrix_size)){                  //keep the bitboard copy in sync
+                board->bits.shots |= BIT_CELL(x,y);
+        }
+        size_t index = (size_t)y * board->Matrix_size + x;
+        Case_type* cell = board->cells + index;                 //one load in the contiguous cases
+        Shot_result result = SHOT_ALREADY;
+        int id = -1;
+        if (*cell == WATER || *cell == BOAT){                   //swap-remove the case from the cases not shot yet
+                int last = board->unshot[--board->nb_unshot];
+                int pos = board->unshot_pos[index];
+                board->unshot[pos] = last;
+                board->unshot_pos[last] = pos;
         }
-        else if (board->matrix[y][x] == BOAT){
-                printf("Touché chef, félicitations !\n");
-                printf("Vous pouvez rejouer votre tour\n");
-                board->matrix[y][x] = WRECK;
-                return 1;
+        if (*cell == WATER){
+                *cell = WATER_SHOT;
+                result = SHOT_MISS;
+        }
+        else if (*cell == BOAT){
+                *cell = WRECK;
+                id = board->boat_ids[index];
+                if(boat_id != NULL){
+                        *boat_id = id;
+                }
+                result = SHOT_HIT;
+                if(--board->hits_left[id] == 0){
+                        board->boats_alive--;
+                        result = SHOT_SUNK;
+                }
         }
+        if(board->log != NULL){                                 //--log: one record per shot
+                moveLogShot(board,x,y,result,id);
+        }
+        return result;
 }
 
 /**
- * @brief Simulates a missile shoot by the enemy bot at a random position on the game board.
- *
- * The function generates random coordinates for the enemy bot's missile shoot,
- * checks the result, and updates the game board accordingly. The bot cans only
- * shoot where he hasn't shooted yet.
+ * @brief Plays the shot of the seat to play with the rules of every mode.
  *
- * @param[in,out] board Pointer to the game board structure.
- * @return 0 if the enemy bot missed, 1 if the enemy bot hit a boat and updates the board.
+ * A bot seat chooses its case with its strategy, while a seat whose strategy
+ * takes its cases from outside (BOT_HUMAN) shoots the case given by gameInput,
+ * or asks it with its blocking choose hook if none was given. The strategy
+ * observes the result, a seat shoots again as long as it hits a boat and wins
+ * when the last boat of the other fleet sinks. Every loop playing games goes
+ * through this function, headless or not.
  *
- * @note The function exits with an error message if the game board pointer is NULL.
+ * @param[in,out] game Pointer to the game, not over, whose seat to play was bound with seatBind.
+ * @param[out] event Shot played.
+ * @return The result of the shot.
  */
-int bot_Missile_Shoot(Game_board* board){
-        if (board == NULL){
-                fprintf(stderr,"Erreur de paramètre");
-                exit(2);
-        }
-        int condition = 0;
+Shot_result gameShot(Game* game, Game_event* event){
+        int seat = game->turn;
+        Seat* place = &game->seats[seat];
+        Bot_type strategy = place->strategy;
+        Game_board* board = seat == 0 ? game->tab_bot : game->tab_player;
         int x,y;
-        while(condition == 0){
-                x = rand()%PLATE_SIZE;
-                y = rand()%PLATE_SIZE;
-                if(board->matrix[y][x] == BOAT || board->matrix[y][x] == WATER){
-                        condition = 1;
-                }
+        if(strategy->input && game->input >= 0){
+                x = game->input % board->Matrix_size;
+                y = game->input / board->Matrix_size;
+                game->input = -1;
         }
-        if (board->matrix[y][x] == WATER){
-                printf("L'ennemi a raté son tir on a eu chaud !\n");
-                board->matrix[y][x] = WATER_SHOT;
-                return 0;
+        else{
+                strategy->choose(place->state,board,seat == 0 ? game->boat_tab_bot : game->boat_tab_player,&x,&y,&game->rng);
         }
-        else if (board->matrix[y][x] == BOAT){
-                printf("Alerte l'ennemi a touché notre bateau !\n");
-                printf("Il va pouvoir retirer !\n");
-                board->matrix[y][x] = WRECK;
-                return 1;
+        int boat_id = -1;
+        game->shots[seat]++;
+        Shot_result result = resolveShot(board,x,y,&boat_id);
+        if(strategy->observe != NULL){
+                strategy->observe(place->state,board,x,y,result,boat_id);
         }
+        if(result == SHOT_SUNK){
+                if(fleetDestroyed(board)){                             //the whole fleet is destroyed
+                        game->winner = seat;
+                }
+        }
+        else if(result != SHOT_HIT){
+                game->turn = 1 - seat;                                 //a miss gives the hand to the other seat
+        }
+        event->seat = seat;
+        event->x = x;
+        event->y = y;
+        event->result = result;
+        event->boat_id = boat_id;
+        return result;
 }
 
 /**
- * @brief Executes the player's turn, allowing them to take shots at the enemy game board.
+ * @brief Advances a game by one event: the shot of the seat to play, when it can shoot now.
  *
- * The function displays the enemy game board, prompts the player to take a shot,
- * processes the result, and updates the display accordingly. If the shot is 
- * successful, the player can play his turn again
+ * The function never blocks: a seat whose strategy takes its cases from outside
+ * (BOT_HUMAN) leaves the game unchanged and asks for its case until gameInput
+ * gives it, and any other shot is played by gameShot. A driver can thus
+ * interleave as many games as it wants on one thread, stepping whichever of them
+ * has its input ready, and do its display and its pauses between two steps.
  *
- * @param[in,out] game Pointer to the game structure.
+ * @param[in,out] game Pointer to the game, whose seats were bound with seatBind.
+ * @param[out] event Shot played, filled when GAME_SHOT is returned.
+ * @return GAME_SHOT if a seat shot, GAME_WAIT if the seat to play waits for gameInput, GAME_OVER if the game is over.
  *
- * @note The function exits with an error message if the game pointer is NULL.
+ * @note The function exits with an error message if a pointer is NULL or if the seat to play is not bound.
  */
-void playerTurn(Game* game){
-        int do_replay = 1;
-        int nbBoatAlive = BOAT_NB;
-        if(game == NULL){
+Game_step gameStep(Game* game, Game_event* event){
+        if(game == NULL || event == NULL || game->seats[game->turn].strategy == NULL){
                 fprintf(stderr,"Erreur de paramètre");
                 exit(2);
         }
-        printf(" --- TABLEAU ENNEMI ---\n\n");
-        ennemyBoardDisplay(game->tab_bot);
-        while(do_replay == 1 && nbBoatAlive != 0){            //The player can shoot again while he touch an ennemy boat and the game is not finished
-                do_replay = missileShoot(game->tab_bot);
-                nbBoatAlive = howManyAlive(game->boat_tab_bot,game->tab_bot);
-                sleep(2);
-                printf(" --- TABLEAU ENNEMI ---\n\n");
-                ennemyBoardDisplay(game->tab_bot);
-                sleep(2);
+        if(game->winner >= 0){
+                return GAME_OVER;
+        }
+        if(game->seats[game->turn].strategy->input && game->input < 0){
+                return GAME_WAIT;
         }
+        gameShot(game,event);
+        return GAME_SHOT;
 }
 
-
 /**
- * @brief Executes the enemy's turn, allowing them to take shots at the player's game board.
+ * @brief Gives its next case to the seat to play, when its strategy takes its cases from outside.
  *
- * The function simulates the enemy's actions, generates a missile shot, processes the result,
- * and updates the display of the player's game board. If the shot is successful, the bot can
- * play again
+ * The case is shot by the next call to gameStep.
  *
- * @param[in,out] game Pointer to the game structure.
+ * @param[in,out] game Pointer to the game.
+ * @param[in] x X-coordinate of the case.
+ * @param[in] y Y-coordinate of the case.
+ * @return 1 if the case was taken, 0 if it is off the board, if the game is over or if the seat to play doesn't wait for a case.
  *
  * @note The function exits with an error message if the game pointer is NULL.
  */
-
-void ennemyTurn(Game* game){
-        int do_replay = 1;
-        int nbBoatAlive = BOAT_NB;
+int gameInput(Game* game, int x, int y){
         if(game == NULL){
                 fprintf(stderr,"Erreur de paramètre");
                 exit(2);
         }
-        while(do_replay == 1 && nbBoatAlive != 0){               //The bot can shoot again while he touch an ennemy boat and the game is not finished
-                printf("L'ennemi se prépare à tirer !\n");
-                sleep(2);
-                do_replay = bot_Missile_Shoot(game->tab_player);
-                nbBoatAlive = howManyAlive(game->boat_tab_player,game->tab_player);
-                sleep(2);
-                printf(" --- VOTRE TABLEAU ---\n\n");
-                gameBoardDisplay(game->tab_player);
-                sleep(2);
+        Bot_type strategy = game->seats[game->turn].strategy;
+        int size = game->tab_player->Matrix_size;
+        if(game->winner >= 0 || strategy == NULL || !strategy->input || x < 0 || y < 0 || x >= size || y >= size){
+                return 0;
         }
+        game->input = y * size + x;
+        return 1;
 }
 
+/**
+ * @brief Displays the message telling a shot, from the point of view of the player.
+ *
+ * @param[in] event Pointer to the shot, as given by gameStep.
+ */
+void shotDisplay(const Game_event* event){
+        int seat = event->seat;
+        if (event->result == SHOT_MISS){
+                printf(seat == 0 ? "Raté, le tir est partit droit dans l'eau !\n" : "L'ennemi a raté son tir on a eu chaud !\n");
+                return;
+        }
+        else if(event->result == SHOT_ALREADY){
+                printf(seat == 0 ? "Vous avez deja tiré ici chef !\n" : "L'ennemi a tiré sur une case déjà touchée !\n");
+                return;
+        }
+        else if(event->result == SHOT_SUNK){
+                if(seat == 0){
+                        printf("Touché coulé chef, le bateau de taille %d est détruit !\n",game_config.boat_sizes[event->boat_id]);
+                }
+                else{
+                        printf("Alerte l'ennemi a coulé notre bateau de taille %d !\n",game_config.boat_sizes[event->boat_id]);
+                }
+        }
+        else{
+                printf(seat == 0 ? "Touché chef, félicitations !\n" : "Alerte l'ennemi a touché notre bateau !\n");
+        }
+        printf(seat == 0 ? "Vous pouvez rejouer votre tour\n" : "Il va pouvoir retirer !\n");
+}
 
+/**
+ * @brief Chooses the case targeted by the enemy bot.
+ *
+ * The function draws one case uniformly among the cases where the bot hasn't
+ * shooted yet, kept in the list of the board, so the draw takes the same time
+ * whatever the size of the board and the number of cases left. It doesn't
+ * modify the board nor display anything.
+ *
+ * @param[in] board Pointer to the targeted game board structure.
+ * @param[out] x X-coordinate chosen by the bot.
+ * @param[out] y Y-coordinate chosen by the bot.
+ * @param[in,out] rng Pointer to the random generator to draw with.
+ *
+ * @note The function exits with an error message if a pointer is NULL or if every case was shot.
+ */
+void botTarget(Game_board* board, int* x, int* y, Rng* rng){
+        if (board == NULL || x == NULL || y == NULL || rng == NULL || board->nb_unshot == 0){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
+        }
+        int cell = board->unshot[rngBounded(rng,board->nb_unshot)];
+        *x = cell % board->Matrix_size;
+        *y = cell / board->Matrix_size;
+        thread_stats.random_moves++;
+}
@@ -0,0 +1,360 @@
+/**
+ * @file Bench.c
+ * @brief microbenchmarks of the core operations of the game
+ * @author Hicham Bettahar
+ * @date December 24, 2023
+ *
+ * Built with 'make bench' as its own optimized program, without the address
+ * sanitizer of exec, and linked with the same lib.a. Each benchmark runs a
+ * batch of operations sized to last about BENCH_RUN_MS, after BENCH_WARMUP_MS
+ * of warmup, BENCH_REPETITIONS times; the median and best time per operation
+ * are displayed, so two versions of the engine can be compared before one is
+ * deployed.
+ *
+ * ./bench/bench [filtre] [--size <taille>] [--fleet <tailles>] [--seed <graine>]
+ * only runs the benchmarks whose name contains the filter.
+ */
+#include "header.h"
+
+#define BENCH_WARMUP_MS 50    /**< Warmup of each benchmark before it is measured, in milliseconds. */
+#define BENCH_RUN_MS 100      /**< Duration of one measured batch, in milliseconds. */
+#define BENCH_REPETITIONS 5   /**< Measured batches of each benchmark. */
+#define BENCH_SAMPLES 256     /**< Prepared boats and fleets the benchmarks go through. */
+
+/**
+ * @brief Structure representing the data prepared once for every benchmark.
+ */
+typedef struct{
+        Rng rng;              /**< Generator of the draws done while measuring. */
+        Boat pairs[BENCH_SAMPLES][2];  /**< Random boats compared by collision. */
+        Boat* fleets;         /**< BENCH_SAMPLES random fleets, overlapping or not, checked by check_collision. */
+        Boat* placed;         /**< BENCH_SAMPLES legal fleets placed by boatPlacement. */
+        Game_board* board;    /**< Board shot by resolveShot. */
+        Game_board* half_shot;/**< Board with half of its cases shot, read by isAlive and howManyAlive. */
+        int* order;           /**< Every case of a board in a random order. */
+        long next_shot;       /**< Position of the next shot of resolveShot in order. */
+        long next_game;       /**< Number of the next full game. */
+}Bench_state;
+
+/**
+ * @brief Function running a number of operations of a benchmark.
+ */
+typedef void (*Bench_function)(Bench_state* state, long nb);
+
+/**
+ * @brief Structure representing a benchmark.
+ */
+typedef struct{
+        const char* name;     /**< Name displayed and matched by the filter. */
+        Bench_function run;   /**< Operations measured. */
+        const char* unit;     /**< Name of one operation in the throughput column. */
+}Bench_case;
+
+static volatile long bench_sink;                 /**< Results of the operations, so the compiler can't drop them. */
+
+/**
+ * @brief Gives the current time of the monotonic clock.
+ *
+ * @return The time, in nanoseconds.
+ */
+static double benchNow(){
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC,&now);
+        return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/**
+ * @brief Places a fleet on a board emptied first, as at the start of a game.
+ *
+ * @param[in,out] board Pointer to the game board structure.
+ * @param[in] boat_list Pointer to the array of boats.
+ */
+static void benchPlace(Game_board* board, Boat* boat_list){
+        gameBoardInit(board);
+        boatPlacement(board,boat_list);
+}
+
+/**
+ * @brief Compares prepared pairs of boats with collision.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchCollision(Bench_state* state, long nb){
+        long found = 0;
+        for(long i = 0; i < nb; i++){
+                Boat* pair = state->pairs[i % BENCH_SAMPLES];
+                found += collision(&pair[0],&pair[1]);
+        }
+        bench_sink = found;
+}
+
+/**
+ * @brief Checks the last boat of prepared fleets against the others with check_collision.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchCheckCollision(Bench_state* state, long nb){
+        long found = 0;
+        for(long i = 0; i < nb; i++){
+                found += check_collision(state->fleets + (i % BENCH_SAMPLES) * game_config.boat_nb,game_config.boat_nb - 1);
+        }
+        bench_sink = found;
+}
+
+/**
+ * @brief Allocates and draws fleets with createBoatList, then frees them.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchCreateBoatList(Bench_state* state, long nb){
+        for(long i = 0; i < nb; i++){
+                Boat* boat_list = createBoatList(&state->rng);
+                bench_sink = boat_list[0].x_pos;
+                free(boat_list);
+        }
+}
+
+/**
+ * @brief Draws fleets in place with drawBoatList, as gameReset does.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchDrawBoatList(Bench_state* state, long nb){
+        for(long i = 0; i < nb; i++){
+                drawBoatList(state->fleets,&state->rng);
+                bench_sink = state->fleets[0].x_pos;
+        }
+}
+
+/**
+ * @brief Empties the board and places a prepared fleet on it.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchBoatPlacement(Bench_state* state, long nb){
+        for(long i = 0; i < nb; i++){
+                benchPlace(state->board,state->placed + (i % BENCH_SAMPLES) * game_config.boat_nb);
+        }
+        bench_sink = state->board->boats_alive;
+}
+
+/**
+ * @brief Checks the boats of the half shot board one by one with isAlive.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchIsAlive(Bench_state* state, long nb){
+        long alive = 0;
+        for(long i = 0; i < nb; i++){
+                alive += isAlive(state->placed + i % game_config.boat_nb,state->half_shot);
+        }
+        bench_sink = alive;
+}
+
+/**
+ * @brief Counts the boats alive on the half shot board with howManyAlive.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchHowManyAlive(Bench_state* state, long nb){
+        long alive = 0;
+        for(long i = 0; i < nb; i++){
+                alive += howManyAlive(state->placed,state->half_shot);
+        }
+        bench_sink = alive;
+}
+
+/**
+ * @brief Shoots every case of the board in a random order with resolveShot, placing a new fleet once all are shot.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchResolveShot(Bench_state* state, long nb){
+        long nb_cells = (long)game_config.plate_size * game_config.plate_size;
+        long hits = 0;
+        for(long i = 0; i < nb; i++){
+                if(state->next_shot == nb_cells){                        //every case is shot: a new board, its cost spread over the shots
+                        benchPlace(state->board,state->placed + (i % BENCH_SAMPLES) * game_config.boat_nb);
+                        state->next_shot = 0;
+                }
+                int cell = state->order[state->next_shot++];
+                hits += resolveShot(state->board,cell % game_config.plate_size,cell / game_config.plate_size,NULL) != SHOT_MISS;
+        }
+        bench_sink = hits;
+}
+
+/**
+ * @brief Plays full games between two bots, as the sim mode does.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of games.
+ * @param[in] bot_player Strategy of the player seat.
+ * @param[in] bot_ennemy Strategy of the bot seat.
+ */
+static void benchGames(Bench_state* state, long nb, Bot_type bot_player, Bot_type bot_ennemy){
+        long shots = 0;
+        for(long i = 0; i < nb; i++){
+                Sim_result result = simulateGame(bot_player,bot_ennemy,rngStreamSeed(game_config.seed,state->next_game++));
+                shots += result.shots[0] + result.shots[1];
+        }
+        bench_sink = shots;
+}
+
+/**
+ * @brief Plays full games between two random bots.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchGameRandom(Bench_state* state, long nb){
+        benchGames(state,nb,BOT_RANDOM,BOT_RANDOM);
+}
+
+/**
+ * @brief Plays full games of a density bot against a random bot.
+ *
+ * @param[in,out] state The prepared data.
+ * @param[in] nb Number of operations.
+ */
+static void benchGameDensity(Bench_state* state, long nb){
+        benchGames(state,nb,BOT_DENSITY,BOT_RANDOM);
+}
+
+static const Bench_case bench_cases[] = {
+        {"collision", benchCollision, "op"},
+        {"check_collision", benchCheckCollision, "op"},
+        {"createBoatList", benchCreateBoatList, "flotte"},
+        {"drawBoatList", benchDrawBoatList, "flotte"},
+        {"gameBoardInit+boatPlacement", benchBoatPlacement, "plateau"},
+        {"isAlive", benchIsAlive, "op"},
+        {"howManyAlive", benchHowManyAlive, "op"},
+        {"resolveShot", benchResolveShot, "tir"},
+        {"partie random/random", benchGameRandom, "partie"},
+        {"partie density/random", benchGameDensity, "partie"},
+};
+
+/**
+ * @brief Prepares the data of the benchmarks.
+ *
+ * @param[out] state The prepared data.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+static void benchPrepare(Bench_state* state){
+        int size = game_config.plate_size;
+        long nb_cells = (long)size * size;
+        rngSeed(&state->rng,game_config.seed);
+        state->fleets = malloc(BENCH_SAMPLES * game_config.boat_nb * sizeof(Boat));
+        state->placed = malloc(BENCH_SAMPLES * game_config.boat_nb * sizeof(Boat));
+        state->order = malloc(nb_cells * sizeof(int));
+        if(state->fleets == NULL || state->placed == NULL || state->order == NULL){
+                fprintf(stderr,"Erreur lors de l'allocation");
+                exit(1);
+        }
+        for(int i = 0; i < BENCH_SAMPLES; i++){
+                state->pairs[i][0] = createBoat(rngBounded(&state->rng,game_config.boat_nb),&state->rng);
+                state->pairs[i][1] = createBoat(rngBounded(&state->rng,game_config.boat_nb),&state->rng);
+                for(int j = 0; j < game_config.boat_nb; j++){
+                        state->fleets[i * game_config.boat_nb + j] = createBoat(j,&state->rng);
+                }
+                drawBoatList(state->placed + i * game_config.boat_nb,&state->rng);
+        }
+        for(long i = 0; i < nb_cells; i++){                              //Fisher-Yates shuffle of the cases
+                state->order[i] = i;
+        }
+        for(long i = nb_cells - 1; i > 0; i--){
+                long j = rngBounded(&state->rng,i + 1);
+                int cell = state->order[i];
+                state->order[i] = state->order[j];
+                state->order[j] = cell;
+        }
+        state->board = createGameBoard(size);
+        benchPlace(state->board,state->placed);
+        state->next_shot = 0;
+        state->half_shot = createGameBoard(size);
+        benchPlace(state->half_shot,state->placed);
+        for(long i = 0; i < nb_cells / 2; i++){
+                resolveShot(state->half_shot,state->order[i] % size,state->order[i] / size,NULL);
+        }
+        state->next_game = 0;
+}
+
+/**
+ * @brief Sorts durations in increasing order, for qsort.
+ *
+ * @param[in] a Pointer to the first duration.
+ * @param[in] b Pointer to the second duration.
+ * @return A negative, zero or positive number as a is shorter, as long or longer than b.
+ */
+static int benchCompare(const void* a, const void* b){
+        double x = *(const double*)a, y = *(const double*)b;
+        return (x > y) - (x < y);
+}
+
+/**
+ * @brief Measures a benchmark and displays its result.
+ *
+ * The number of operations of a batch is doubled until a batch lasts
+ * BENCH_RUN_MS, which also warms the caches and the branch predictors up,
+ * then the benchmark keeps running until BENCH_WARMUP_MS have passed, and
+ * BENCH_REPETITIONS batches are measured.
+ *
+ * @param[in] bench The benchmark.
+ * @param[in,out] state The prepared data.
+ */
+static void benchMeasure(const Bench_case* bench, Bench_state* state){
+        long nb = 1;
+        double start = benchNow();
+        double elapsed;
+        while(1){
+                double batch_start = benchNow();
+                bench->run(state,nb);
+                elapsed = benchNow() - batch_start;
+                if(elapsed >= BENCH_RUN_MS * 1e6 || nb > (1L << 40)){
+                        break;
+                }
+                nb = (elapsed < BENCH_RUN_MS * 1e5) ? nb * 2 : (long)(nb * BENCH_RUN_MS * 1e6 / elapsed) + 1;
+        }
+        while(benchNow() - start < BENCH_WARMUP_MS * 1e6){
+                bench->run(state,nb);
+        }
+        double per_op[BENCH_REPETITIONS];
+        for(int r = 0; r < BENCH_REPETITIONS; r++){
+                double batch_start = benchNow();
+                bench->run(state,nb);
+                per_op[r] = (benchNow() - batch_start) / nb;
+        }
+        qsort(per_op,BENCH_REPETITIONS,sizeof(double),benchCompare);
+        double median = per_op[BENCH_REPETITIONS / 2];
+        printf("%-30s %12.1f ns/op  (min %10.1f)  %14.0f %s/s\n",bench->name,median,per_op[0],1e9 / median,bench->unit);
+        fflush(stdout);
+}
+
+int main(int argc, char** argv){
+        configInit(&argc,argv);
+        check_const();
+        const char* filter = (argc > 1) ? argv[1] : "";
+        Bench_state state;
+        benchPrepare(&state);
+        printf("--- BENCHMARKS: plateau %d, %d bateaux, graine %llu, médiane de %d mesures de %d ms ---\n",
+               game_config.plate_size,game_config.boat_nb,(unsigned long long)game_config.seed,BENCH_REPETITIONS,BENCH_RUN_MS);
+        for(size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++){
+                if(strstr(bench_cases[i].name,filter) != NULL){
+                        benchMeasure(&bench_cases[i],&state);
+                }
+        }
+        freeGameBoard(state.board);
+        freeGameBoard(state.half_shot);
+        free(state.fleets);
+        free(state.placed);
+        free(state.order);
+        return 0;
+}
@@ -6,6 +6,11 @@
  */
 #include "header.h"
 
+static __thread unsigned char* occupancy = NULL;         /**< Occupancy grid of the thread: 1 on the cases a new boat can't cover. */
+static __thread size_t occupancy_cells = 0;              /**< Cases of the occupancy grid of the thread. */
+static pthread_key_t occupancy_key;                      /**< Frees the occupancy grid of a thread when it ends. */
+static pthread_once_t occupancy_once = PTHREAD_ONCE_INIT;
+
 /**
  * @brief Creates a new boat with the specified indicator (coming right from the "createBoatList" function).
  *
@@ -13,25 +18,26 @@
  * The boat's orientation, position, and size are determined randomly.
  *
  * @param[in] indicator An integer indicator for determining the boat size.
+ * @param[in,out] rng Pointer to the random generator to draw with.
  * @return The newly created boat.
  *
- * @note The function exits with an error message if the indicator is negative.
+ * @note The function exits with an error message if the indicator is negative or beyond the fleet.
  */
-Boat createBoat(int indicator){
-        if(indicator < 0){                                    //checking parameters to avoid errors
+Boat createBoat(int indicator, Rng* rng){
+        if(indicator < 0 || indicator >= game_config.boat_nb){ //checking parameters to avoid errors
                 fprintf(stderr,"Erreur de paramètre");
                 exit(2);
         }
         Boat new_Boat;
-        new_Boat.boat_size = indicator + 1;                     //setting the boat size based on the indicator 
-        new_Boat.orientation = rand()%2;                        //randomly determines orientation (0 = horizontal, 1 = vertical)
+        new_Boat.boat_size = game_config.boat_sizes[indicator]; //setting the boat size based on the indicator and the fleet of the configuration
+        new_Boat.orientation = rngBounded(rng,2);                        //randomly determines orientation (0 = horizontal, 1 = vertical)
         if(new_Boat.orientation == 0){                          // Randomly determine the position based on the orientation to stay in the array
-                new_Boat.x_pos = rand()%(PLATE_SIZE - new_Boat.boat_size) ;
-                new_Boat.y_pos = rand()%(PLATE_SIZE);
+                new_Boat.x_pos = rngBounded(rng,game_config.plate_size - new_Boat.boat_size + 1) ;
+                new_Boat.y_pos = rngBounded(rng,game_config.plate_size);
         }
         if(new_Boat.orientation == 1){
-                new_Boat.x_pos = rand()%PLATE_SIZE;
-                new_Boat.y_pos = rand()%(PLATE_SIZE - new_Boat.boat_size);
+                new_Boat.x_pos = rngBounded(rng,game_config.plate_size);
+                new_Boat.y_pos = rngBounded(rng,game_config.plate_size - new_Boat.boat_size + 1);
         }
         
         return new_Boat;
@@ -40,35 +46,161 @@ Boat createBoat(int indicator){
 /**
  * @brief Creates an array of boats representing the player's boats.
  *
- * The function allocates memory for an array of boats, generates each boat,
- * and ensures there are no collisions between boats.
+ * The function allocates memory for an array of boats and draws the fleet with drawBoatList.
  *
+ * @param[in,out] rng Pointer to the random generator to draw the fleet with.
  * @return A pointer to the array of boats.
  *
  * @note The function exits with an error message if memory allocation fails.
  */
-Boat* createBoatList(){
-        Boat* boatList = malloc(BOAT_NB * sizeof(Boat));             //allocate memory for the array/list of boats
+Boat* createBoatList(Rng* rng){
+        Boat* boatList = malloc(game_config.boat_nb * sizeof(Boat));             //allocate memory for the array/list of boats
         if (boatList == NULL) {                                      //checking allocation error
                 fprintf(stderr, "Erreur lors de l'allocation");
                 exit(1);
         }
+        drawBoatList(boatList,rng);
+        return boatList;
+}
+
+/**
+ * @brief Frees the occupancy grid of a thread that ends.
+ *
+ * @param[in] grid The occupancy grid of the thread.
+ */
+static void occupancyFree(void* grid){
+        free(grid);
+}
+
+/**
+ * @brief Creates the key freeing the occupancy grid of each thread.
+ */
+static void occupancyKeyInit(){
+        pthread_key_create(&occupancy_key,occupancyFree);
+}
+
+/**
+ * @brief Gives the occupancy grid of the calling thread, every case at 0.
+ *
+ * @return The grid, one byte per case of the configured board.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+static unsigned char* occupancyGrid(){
+        size_t nb_cells = (size_t)game_config.plate_size * game_config.plate_size;
+        if(occupancy_cells < nb_cells){
+                pthread_once(&occupancy_once,occupancyKeyInit);
+                free(occupancy);
+                occupancy = calloc(nb_cells,1);
+                if(occupancy == NULL){
+                        fprintf(stderr,"Erreur lors de l'allocation");
+                        exit(1);
+                }
+                occupancy_cells = nb_cells;
+                pthread_setspecific(occupancy_key,occupancy);
+        }
+        return occupancy;
+}
+
+/**
+ * @brief Checks whether a boat only covers free cases of an occupancy grid.
+ *
+ * @param[in] grid The occupancy grid.
+ * @param[in] boat Pointer to the boat, inside the board.
+ * @return 1 if one of its cases is taken, 0 otherwise.
+ */
+static int occupancyCollision(const unsigned char* grid, Boat* boat){
+        size_t size = game_config.plate_size;
+        size_t step = (boat->orientation == 0) ? 1 : size;
+        const unsigned char* cell = grid + boat->y_pos * size + boat->x_pos;
+        unsigned char taken = 0;
+        for(int k = 0; k < boat->boat_size; k++){                //no early exit: the loop is short and branch free
+                taken |= cell[k * step];
+        }
+        return taken != 0;
+}
+
+/**
+ * @brief Marks or clears on an occupancy grid the cases a boat forbids to the next ones.
+ *
+ * These are its own cases and, with a no-touch margin, the cases around it up to the margin.
+ *
+ * @param[in,out] grid The occupancy grid.
+ * @param[in] boat Pointer to the boat.
+ * @param[in] value 1 to mark the cases, 0 to clear them.
+ */
+static void occupancyMark(unsigned char* grid, Boat* boat, unsigned char value){
+        int size = game_config.plate_size;
+        int margin = game_config.margin;
+        int x_min = boat->x_pos - margin;
+        int y_min = boat->y_pos - margin;
+        int x_max = boat->x_pos + (boat->orientation == 0 ? boat->boat_size - 1 : 0) + margin;
+        int y_max = boat->y_pos + (boat->orientation == 0 ? 0 : boat->boat_size - 1) + margin;
+        x_min = (x_min < 0) ? 0 : x_min;
+        y_min = (y_min < 0) ? 0 : y_min;
+        x_max = (x_max >= size) ? size - 1 : x_max;
+        y_max = (y_max >= size) ? size - 1 : y_max;
+        for(int y = y_min; y <= y_max; y++){
+                memset(grid + (size_t)y * size + x_min,value,x_max - x_min + 1);
+        }
+}
+
+/**
+ * @brief Draws a fleet into an existing array of boats.
+ *
+ * The fleet is drawn from the table of legal placements when the board fits in a bitboard.
+ * On bigger boards the function generates each boat and checks it against an
+ * occupancy grid of the cases taken by the previous boats and their margin, in
+ * time proportional to its size whatever the number of boats. If a boat can't be placed
+ * after MAX_PLACEMENT_ATTEMPTS tries, the whole fleet is generated again so the
+ * function always ends.
+ *
+ * @param[out] boatList Pointer to an array of game_config.boat_nb boats.
+ * @param[in,out] rng Pointer to the random generator to draw the fleet with.
+ *
+ * @note The function exits with an error message if memory allocation fails.
+ */
+void drawBoatList(Boat* boatList, Rng* rng){
+        Stats* stats = statsThread();
+        stats->fleets++;
+        if(bitBoardFits(game_config.plate_size)){                                //draw the fleet from the table of legal placements
+                stats->fleet_restarts += placeFleet(boatList,rng);
+                return;
+        }
+        unsigned char* grid = occupancyGrid();
         int collision;
-        for (int i = 0; i < BOAT_NB; i++){                     //generate each boat and check for collisions
+        int attempts;
+        uint64_t retries = 0;
+        for (int i = 0; i < game_config.boat_nb; i++){         //generate each boat and check it against the grid
                 collision = 1;
-                while(collision == 1){
-                        boatList[i] = createBoat(i);
-                        collision = check_collision(boatList, i);         //if there are collisions, we recreate the boat
+                attempts = 0;
+                while(collision == 1 && attempts < MAX_PLACEMENT_ATTEMPTS){
+                        boatList[i] = createBoat(i,rng);
+                        collision = occupancyCollision(grid,&boatList[i]);     //if there are collisions, we recreate the boat
+                        attempts++;
+                }
+                retries += attempts - 1;
+                if(collision == 1){                                   //the previous boats leave no room for this one, we restart the whole fleet
+                        stats->fleet_restarts++;
+                        for(int j = 0; j < i; j++){
+                                occupancyMark(grid,&boatList[j],0);
+                        }
+                        i = -1;
+                        continue;
                 }
+                occupancyMark(grid,&boatList[i],1);
         }
-        return boatList;
+        for(int i = 0; i < game_config.boat_nb; i++){          //the grid is left empty for the next fleet
+                occupancyMark(grid,&boatList[i],0);
+        }
+        stats->placement_retries += retries;
 }
 
 /**
  * @brief Checks for collisions between a newly created boat and existing boats.
  *
  * The function checks if the newly created boat collides with any of the existing
- * boats in the array.
+ * boats in the array, one pair at a time; drawBoatList uses an occupancy grid instead.
  *
  * @param[in] boat_list Pointer to the array of boats.
  * @param[in] nb Index of the newly created boat in the array.
@@ -97,7 +229,10 @@ int check_collision(Boat* boat_list,int nb){
 /**
  * @brief Checks for collision between two boats.
  *
- * The function checks if two boats collide based on their positions and orientations.
+ * Two boats collide when their rectangles, grown by the no-touch margin of the
+ * configuration, intersect: with a margin of 0 they may touch but not overlap,
+ * with a margin of 1 they may not touch, even by a corner. The same test
+ * handles every pair of orientations.
  *
  * @param[in] boat1 Pointer to the first boat.
  * @param[in] boat2 Pointer to the second boat.
@@ -110,36 +245,22 @@ int collision(Boat* boat1, Boat* boat2) {
                 fprintf(stderr,"Erreur de paramètre");
                 exit(2);
         }
-    // Check if the boats are in the same position
-        if (boat1->x_pos == boat2->x_pos && boat1->y_pos == boat2->y_pos) {
-                return 1;
-        }
-
-    // Check for overlap based on boat orientations
-        if (boat1->orientation == 0 && boat2->orientation == 0) {
-        // Both boats are horizontal
-                if( (boat1->y_pos == boat2->y_pos) && ((boat1->x_pos <= boat2->x_pos + boat2->boat_size - 1) && (boat1->x_pos + boat1->boat_size - 1 >= boat2->x_pos))){
-                        return 1;
-                }
-        } else if (boat1->orientation == 1 && boat2->orientation == 1) {
-        // Both boats are vertical
-                if ((boat1->x_pos == boat2->x_pos) && ((boat1->y_pos <= boat2->y_pos + boat2->boat_size - 1) && (boat1->y_pos + boat1->boat_size - 1 >= boat2->y_pos))){
-                        return 1;
-                }
-        } else {
-        // Boats have different orientations
-                if (((boat1->x_pos >= boat2->x_pos - 1 && boat1->x_pos <= boat2->x_pos + boat2->boat_size) || (boat2->x_pos >= boat1->x_pos - 1 && boat2->x_pos <= boat1->x_pos + boat1->boat_size)) && ((boat1->y_pos >= boat2->y_pos - 1 && boat1->y_pos <= boat2->y_pos + boat2->boat_size) || (boat2->y_pos >= boat1->y_pos - 1 && boat2->y_pos <= boat1->y_pos + boat1->boat_size))){
-                        return 1;
-                }
-        }
-        // No collision detected
-         return 0;
+        int margin = game_config.margin;
+        int width1 = boat1->orientation == 0 ? boat1->boat_size : 1;    //horizontal boats are boat_size cases wide
+        int height1 = boat1->orientation == 0 ? 1 : boat1->boat_size;
+        int width2 = boat2->orientation == 0 ? boat2->boat_size : 1;
+        int height2 = boat2->orientation == 0 ? 1 : boat2->boat_size;
+        return boat1->x_pos < boat2->x_pos + width2 + margin && boat2->x_pos < boat1->x_pos + width1 + margin
+            && boat1->y_pos < boat2->y_pos + height2 + margin && boat2->y_pos < boat1->y_pos + height1 + margin;
 }
 
 /**
  * @brief Places boats on the game board based on their positions and orientations.
  *
- * The function updates the game board matrix with boat positions.
+ * The function updates the game board matrix with boat positions through the
+ * kernel of the board size, as well as its bitboard copy when the board is small enough.
+ * It also records which boat lies on each case and resets the intact cases of
+ * every boat, so the shots can tell at once whether a boat is sunk.
  *
  * @param[in] board Pointer to the game board structure.
  * @param[in] boat_list Pointer to the array of boats.
@@ -151,17 +272,13 @@ void boatPlacement(Game_board* board, Boat* boat_list){
                 fprintf(stderr,"Erreur de paramètres");
                 exit(2);
         }
-        for (int i = 0; i < BOAT_NB; i++){
-                if(boat_list[i].orientation == 0){              //Boat is horizontal
-                        for(int j = boat_list[i].x_pos; j < (boat_list[i].x_pos + boat_list[i].boat_size);j++){        //we go trough every position where the boat is on the board and update it as a 'BOAT' 
-                                board->matrix[boat_list[i].y_pos][j]= BOAT;
-                        }
-                }
-                else if(boat_list[i].orientation==1){          //Boat is vertical
-                        for(int k = boat_list[i].y_pos; k < (boat_list[i].y_pos + boat_list[i].boat_size); k++){      //we go trough every position where the boat is on the board and update it as a 'BOAT'
-                                board->matrix[k][boat_list[i].x_pos]= BOAT;
-                        }
-                }
+        board->kernels->placement(board->cells,board->boat_ids,board->Matrix_size,boat_list,game_config.boat_nb);
+        for (int i = 0; i < game_config.boat_nb; i++){
+                board->hits_left[i] = boat_list[i].boat_size;
+        }
+        board->boats_alive = game_config.boat_nb;
+        if(bitBoardFits(board->Matrix_size)){                  //keep the bitboard copy in sync
+                bitBoatPlacement(&board->bits,boat_list);
         }
 } 
 
@@ -204,8 +321,8 @@ int isAlive(Boat* boat, Game_board* game){
 /**
  * @brief Counts the number of alive boats in the game board.
  *
- * The function iterates through the array of boats and checks how many boats are
- * still alive on the game board based on their positions and orientations.
+ * The count is kept up to date by resolveShot, so the function doesn't look at
+ * the boats anymore.
  *
  * @param[in] boat_list Pointer to the array of boats.
  * @param[in] board Pointer to the game board structure.
@@ -218,11 +335,23 @@ int howManyAlive(Boat* boat_list,Game_board* board){
                 fprintf(stderr,"Erreur de paramètre");
                 exit(2);
         }
-        int compt = 0;                                     
-        for(int i = 0; i < BOAT_NB; i++){                 //for each boat we check if it is still alive
-                if (isAlive(&boat_list[i],board) == 1){
-                        compt ++;
-                }
+        return board->boats_alive;
+}
+
+/**
+ * @brief Checks if every boat of the game board has been destroyed.
+ *
+ * The check reads the number of boats not sunk yet, kept up to date by resolveShot.
+ *
+ * @param[in] board Pointer to the game board structure.
+ * @return 1 if the whole fleet is destroyed, 0 otherwise.
+ *
+ * @note The function exits with an error message if the parameter is NULL.
+ */
+int fleetDestroyed(Game_board* board){
+        if(board == NULL){
+                fprintf(stderr,"Erreur de paramètre");
+                exit(2);
         }
-        return compt;         // Return the number of alive boats
-} 
+        return board->boats_alive == 0;
+}
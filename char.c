@@ -29,7 +29,7 @@ void clearInputBuffer(){
 int getMissile_X(){
         int res,check;
         printf("A quelle abcisse souhaitez vous envoyé le missile ?\n");
-        while( (check = scanf("%d",&res)) != 1 || res < 0 || res >= PLATE_SIZE){          //checking if the input is correct
+        while( (check = scanf("%d",&res)) != 1 || res < 0 || res >= game_config.plate_size){          //checking if the input is correct
                 clearInputBuffer();
                 printf("Valeur sasie incorrecte\n");
         }
@@ -47,7 +47,7 @@ int getMissile_X(){
 int getMissile_Y(){
         int res,check;
         printf("A quelle ordonnée souhaitez vous envoyez le missile ?\n");
-        while( (check = scanf("%d",&res)) != 1 || res < 0 || res >= PLATE_SIZE){           //checking if the input is correct
+        while( (check = scanf("%d",&res)) != 1 || res < 0 || res >= game_config.plate_size){           //checking if the input is correct
                 clearInputBuffer();
                 printf("Valeur sasie incorrecte\n");
         }
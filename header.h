@@ -8,14 +8,37 @@
  * @date December 24, 2023
  */
 
-        #define BOAT_NB 6   /**< Number of boats in the game. */
-        #define PLATE_SIZE 10     /**< Size of the game board. */
+        #define BOAT_NB 6   /**< Default number of boats in the game, boat i having size i + 1. */
+        #define PLATE_SIZE 10     /**< Default size of the game board. */
+        #define MAX_PLACEMENT_ATTEMPTS 1000   /**< Number of tries to place a boat before generating the fleet again. */
+        #define BITBOARD_STRIDE 11   /**< Bits per row of a bitboard, one more than the widest board it can hold. */
+        #define DENSITY_PLANES 16    /**< Bits of the per-case placement counters of the density bot. */
+        #define DENSITY_MAX_SIZE 64  /**< Widest board handled by the row-mask density kernels. */
+        #define MC_BUDGET_MS 5        /**< Time budget of one Monte Carlo decision, in milliseconds. */
+        #define MC_MAX_SAMPLES 20000 /**< Number of consistent layouts after which a Monte Carlo decision stops early. */
+        #define BATCH_LANES 16       /**< Games played in lockstep by the batch engine. */
+        #define STRATEGY_STATE_SIZE 64 /**< Bytes of state kept in a game for the strategy of each seat. */
+        #define BOOK_DEPTH 12        /**< Default number of shots covered by an opening book. */
+        #define BOOK_MIN_REACH 0.001 /**< Share of the games below which a line of the opening book isn't computed. */
+        #define TOURNAMENT_CHUNK 256 /**< Number of games of a tournament task. */
+        #define MOVE_LOG_BUFFER 4096 /**< Records kept by each thread before they are appended to the move log. */
+        #define MOVE_START 255       /**< Kind of the record starting a game in the move log (a shot has its Shot_result as kind). */
+        #define MOVE_NO_BOAT 0xFFFF  /**< Boat of a record of the move log that didn't hit any boat. */
+        #define GAME_POOL_CHUNK 32   /**< Games carved from one arena block of a game pool. */
+        #define ARENA_ROUND(n) (((n) + 15) & ~(size_t)15)   /**< Size rounded up so the next piece of an arena block is aligned for a Bitmask. */
+        #define BIT_CELL(x,y) ((Bitmask)1 << ((y) * BITBOARD_STRIDE + (x)))   /**< Mask of the case (x,y) in a bitboard. */
 
+        #include <stdint.h>
         #include <stdio.h>
         #include <stdlib.h>
         #include <string.h>
         #include <time.h>
         #include <unistd.h>
+        #include <pthread.h>
+        #include <math.h>
+        #include <fcntl.h>
+        #include <sys/mman.h>
+        #include <sys/stat.h>
 
         /**
         * @brief Enumeration representing different types of cases on the game board.
@@ -27,6 +50,23 @@
                 WRECK         /**< Wrecked boat on the game board. */
         }Case_type;
 
+        /**
+        * @brief Enumeration representing the outcome of a missile shoot.
+        */
+        typedef enum{
+                SHOT_MISS,    /**< The missile fell into the water. */
+                SHOT_HIT,     /**< The missile hit a boat. */
+                SHOT_SUNK,    /**< The missile hit the last intact case of a boat. */
+                SHOT_ALREADY  /**< The case had already been shot. */
+        }Shot_result;
+
+        /**
+        * @brief Structure representing the state of a xoshiro256** pseudo-random generator.
+        */
+        typedef struct{
+                uint64_t s[4];        /**< The four words of the generator state. */
+        }Rng;
+
         /**
         * @brief Structure representing a boat with its size, position, and orientation.
         */
@@ -37,14 +77,144 @@
                 int orientation;      /**< Orientation of the boat (0 for horizontal, 1 for vertical). */
         }Boat;
 
+        /**
+        * @brief 128-bit mask with one bit per case of a bitboard.
+        */
+        typedef unsigned __int128 Bitmask;
+
+        /**
+        * @brief Structure representing a game board as two masks, a wreck being a case set in both.
+        */
+        typedef struct{
+                Bitmask boats;        /**< Cases occupied by a boat. */
+                Bitmask shots;        /**< Cases already shot. */
+        }Bit_board;
+
+        /**
+        * @brief Structure representing a legal position of a boat with the cases it covers.
+        */
+        typedef struct{
+                Boat boat;            /**< The boat at this position. */
+                Bitmask mask;         /**< Bitboard mask of the cases covered by the boat. */
+        }Placement;
+
+        /**
+        * @brief Structure representing the append-only move log shared by every thread (see MoveLog.c).
+        */
+        typedef struct{
+                int fd;               /**< File of the log, opened in append mode. */
+                uint32_t next_game;   /**< Number given to the next game logged. */
+        }Move_log;
+
+        /**
+        * @brief Structure representing an opening book mapped in memory (see Book.c).
+        */
+        typedef struct{
+                const void* map;      /**< The mapped file. */
+                size_t map_size;      /**< Size of the mapped file. */
+                const uint8_t* shots; /**< Case shot in each position of the tree, 255 outside of the book. */
+                int depth;            /**< Number of shots covered by the book. */
+        }Opening_book;
+
+        /**
+        * @brief Structure representing a fixed-size record of the move log: the start of a game or a shot.
+        */
+        typedef struct{
+                uint32_t game;        /**< Number of the game in the log. */
+                uint8_t kind;         /**< MOVE_START, or the Shot_result of the shot. */
+                uint8_t seat;         /**< Seat that shot (0 for the player side, 1 for the bot side). */
+                uint16_t boat;        /**< Index of the boat hit, MOVE_NO_BOAT if none. */
+                union{
+                        struct{
+                                uint16_t x;   /**< X-coordinate of the shot. */
+                                uint16_t y;   /**< Y-coordinate of the shot. */
+                        }shot;
+                        uint64_t seed;        /**< Seed of the game, for MOVE_START. */
+                };
+        }Move_record;
+
+        /**
+        * @brief Kernels of the hot loops on a board, specialized for its size (see Kernels.c).
+        */
+        typedef struct{
+                void (*placement)(Case_type* cells, int* boat_ids, int size, Boat* boat_list, int nb);  /**< Writes the boats of a fleet and their index on the cases. */
+                void (*density)(const uint64_t* free_rows, const uint64_t* hit_rows, const uint64_t* unshot_rows,
+                                const int* sizes, int nb_sizes, int size, int* x, int* y);      /**< Chooses the densest unshot case from row masks. */
+        }Board_kernels;
+
         /**
         * @brief Structure representing a game board.
         */
         typedef struct{
-                Case_type** matrix;   /**< 2D array representing the game board. */
+                Case_type** matrix;   /**< 2D array representing the game board, each row pointing into cells. */
+                Case_type* cells;     /**< Cases of the board, row after row in one contiguous block. */
+                int* boat_ids;        /**< Index in the fleet of the boat on each case, only meaningful on 'BOAT' and 'WRECK' cases. */
+                int* hits_left;       /**< Intact cases of each boat of the fleet. */
+                int boats_alive;      /**< Boats of the fleet not sunk yet. */
+                int* unshot;          /**< Index of every case not shot yet, in no particular order. */
+                int* unshot_pos;      /**< Position of each case in unshot while it isn't shot. */
+                int nb_unshot;        /**< Number of cases not shot yet. */
+                Move_log* log;        /**< Log recording the shots at the board, NULL if they aren't logged. */
+                uint32_t log_game;    /**< Number of the game in the log. */
+                int log_seat;         /**< Seat shooting at the board. */
                 int Matrix_size;      /**< Size of the game board. */
+                Bit_board bits;       /**< Bitboard copy of the matrix, only kept up to date when bitBoardFits(Matrix_size). */
+                const Board_kernels* kernels; /**< Kernels specialized for Matrix_size. */
         }Game_board;                  
 
+        /**
+        * @brief Structure representing the frame-buffered renderer of the boards (see Render.c).
+        */
+        typedef struct{
+                char* buffer;         /**< Frame formatted before being written at once, allocated for the size of the boards. */
+                size_t capacity;      /**< Size of the frame buffer. */
+                char* previous;       /**< Symbols on the screen for each case of both boards, compared in ANSI mode. */
+                int size;             /**< Size of the game boards drawn. */
+                int ansi;             /**< 1 to redraw only the cases that changed, 0 to draw full frames. */
+                int drawn;            /**< 1 once a full frame is on the screen. */
+        }Renderer;
+
+        /**
+        * @brief Structure representing a strategy a seat can play with: its hooks and the size of its state (see Strategy.c).
+        *
+        * Every hook gets the state of the seat, STRATEGY_STATE_SIZE bytes kept in the game and
+        * cleared before init; a strategy needing more memory allocates it in init and frees it in reset.
+        */
+        typedef struct{
+                const char* name;     /**< Name of the strategy on the command line. */
+                size_t state_size;    /**< Bytes of state used by the strategy, at most STRATEGY_STATE_SIZE. */
+                void (*init)(void* state, Game_board* board, Boat* boat_list);   /**< Called when a seat starts playing on the targeted board, may be NULL. */
+                void (*choose)(void* state, Game_board* board, Boat* boat_list, int* x, int* y, Rng* rng);  /**< Chooses the case to shoot, without modifying the board. */
+                void (*observe)(void* state, Game_board* board, int x, int y, Shot_result result, int boat_id);  /**< Learns the result of the shot, may be NULL. */
+                void (*reset)(void* state);   /**< Called when the seat stops playing with the strategy, may be NULL. */
+                int input;            /**< 1 if the seat shoots the cases given by gameInput, choose being only the blocking way to ask them. */
+        }Strategy;
+
+        /**
+        * @brief Handle on a strategy of the registry, given to the simulation, tournament, server and script modes.
+        */
+        typedef const Strategy* Bot_type;
+
+        extern const Strategy strategy_random;
+        extern const Strategy strategy_density;
+        extern const Strategy strategy_monte_carlo;
+        extern const Strategy strategy_parity;
+        extern const Strategy strategy_human;
+
+        #define BOT_RANDOM (&strategy_random)              /**< Shoots a random case not shot yet. */
+        #define BOT_DENSITY (&strategy_density)            /**< Shoots the case covered by the most placements of the remaining boats. */
+        #define BOT_MONTE_CARLO (&strategy_monte_carlo)    /**< Shoots the case occupied in the most sampled fleet layouts consistent with the board. */
+        #define BOT_PARITY (&strategy_parity)              /**< Hunts on the even cases of a checkerboard, then shoots next to the wrecks of the boats afloat. */
+        #define BOT_HUMAN (&strategy_human)                /**< Asks the coordinates on the standard input. */
+
+        /**
+        * @brief Structure representing a seat of a game: the strategy playing it and its state.
+        */
+        typedef struct{
+                Bot_type strategy;    /**< Strategy of the seat, NULL until seatBind. */
+                _Alignas(16) unsigned char state[STRATEGY_STATE_SIZE];   /**< State of the strategy. */
+        }Seat;
+
         /**
         * @brief Structure representing the game with player and enemy game boards.
         */
@@ -53,17 +223,150 @@
                 Game_board* tab_bot;         /**< Enemy's game board. */
                 Boat* boat_tab_player;       /**< Array of player's boats. */
                 Boat* boat_tab_bot;          /**< Array of enemy's boats. */
+                Rng rng;                     /**< Random generator of every draw of the game. */
+                Renderer* renderer;          /**< Renderer of the interactive game, created by its first display. */
+                int turn;                    /**< Seat to shoot next (0 for the player side, 1 for the bot side). */
+                int shots[2];                /**< Number of missiles fired by each seat. */
+                int winner;                  /**< Winning seat, -1 while the game goes on. */
+                Seat seats[2];               /**< Strategy of each seat and its state. */
+                int input;                   /**< Case given by gameInput to the seat to play, -1 if none. */
         }Game;
+
+        /**
+        * @brief Enumeration representing what a call to gameStep did.
+        */
+        typedef enum{
+                GAME_SHOT,    /**< A seat shot, the shot is in the event. */
+                GAME_WAIT,    /**< The seat to play waits for a case from gameInput, nothing changed. */
+                GAME_OVER     /**< The game is over, nothing changed. */
+        }Game_step;
+
+        /**
+        * @brief Structure representing the shot played by a call to gameStep.
+        */
+        typedef struct{
+                int seat;             /**< Seat which shot. */
+                int x;                /**< X-coordinate of the shot. */
+                int y;                /**< Y-coordinate of the shot. */
+                Shot_result result;   /**< Result of the shot. */
+                int boat_id;          /**< Index in the fleet of the boat hit, -1 if no boat was hit. */
+        }Game_event;
+
+        /**
+        * @brief Structure representing a pool of games reset and reused in place (see GamePool.c).
+        */
+        typedef struct{
+                char** chunks;               /**< Arena blocks, each holding GAME_POOL_CHUNK games. */
+                int nb_chunks;               /**< Number of arena blocks. */
+                Game** free_games;           /**< Games given back, ready to be reused, room for every game of the pool. */
+                int nb_free;                 /**< Number of games given back. */
+        }Game_pool;
+
+        /**
+        * @brief Structure representing the configuration of the games, chosen when the program starts.
+        */
+        typedef struct{
+                int plate_size;       /**< Size of the game board. */
+                int boat_nb;          /**< Number of boats of each fleet. */
+                int* boat_sizes;      /**< Size of each boat of the fleet. */
+                int max_boat_size;    /**< Size of the biggest boat. */
+                uint64_t seed;        /**< Seed of the run. */
+                int margin;           /**< Free cases required between two boats of a fleet, 0 if they may touch. */
+                int ansi;             /**< 1 if the interactive game redraws only the cases that changed. */
+                Move_log* log;        /**< Log of every shot of the run, NULL without --log. */
+                Opening_book* book;   /**< Opening book of the Monte Carlo bot, NULL without --book. */
+                int mc_threads;       /**< Sampling threads of a Monte Carlo decision, one per core if not positive; 1 in the modes playing games on several threads, set before they start. */
+        }Game_config;
+
+        extern Game_config game_config;
+
+        /**
+        * @brief Structure representing the counters of the hot paths of the engine (see Stats.c).
+        */
+        typedef struct{
+                uint64_t games;              /**< Games played to the end. */
+                uint64_t shots;              /**< Shots of the finished games. */
+                uint64_t shots_max;          /**< Most shots of a single game. */
+                uint64_t fleets;             /**< Fleets drawn. */
+                uint64_t placement_retries;  /**< Boats drawn again because they overlapped the fleet. */
+                uint64_t fleet_restarts;     /**< Fleets started again because a boat had no room left. */
+                uint64_t random_moves;       /**< Cases chosen by the random bot. */
+                uint64_t fleet_ns;           /**< Time spent drawing fleets, in nanoseconds. */
+                uint64_t placement_ns;       /**< Time spent emptying boards and placing fleets, in nanoseconds. */
+                uint64_t play_ns;            /**< Time spent playing the shots of bots, in nanoseconds. */
+        }Stats;
+
+        extern __thread Stats thread_stats;
+
+        /**
+        * @brief Function executed by a task of the thread pool.
+        */
+        typedef void (*Task_function)(void* arg);
+
+        /**
+        * @brief Structure representing a task of the thread pool.
+        */
+        typedef struct{
+                Task_function function;       /**< Function to execute. */
+                void* arg;                    /**< Argument given to the function. */
+        }Task;
+
+        /**
+        * @brief Structure representing the queue of tasks owned by a worker of the thread pool.
+        */
+        typedef struct{
+                pthread_mutex_t lock;         /**< Lock protecting the queue. */
+                Task* tasks;                  /**< Array of the tasks. */
+                int head;                     /**< Index of the oldest task, taken by the thieves. */
+                int tail;                     /**< Index after the newest task, taken by the owner. */
+                int capacity;                 /**< Size of the array of tasks. */
+        }Work_queue;
+
+        /**
+        * @brief Structure representing a work-stealing thread pool.
+        */
+        typedef struct{
+                int nb_workers;               /**< Number of worker threads. */
+                Work_queue* queues;           /**< Queue of each worker. */
+                int next_queue;               /**< Queue receiving the next submitted task. */
+        }Thread_pool;
+
+        /**
+        * @brief Structure representing the sampling threads of a Monte Carlo seat, started once and woken up at each decision (see MonteCarlo.c).
+        */
+        typedef struct{
+                int nb_threads;               /**< Number of sampling threads, the caller of monteCarloTarget included. */
+                struct Mc_worker* workers;    /**< Work of each thread. */
+                pthread_mutex_t lock;         /**< Lock protecting round, running and stop. */
+                pthread_cond_t start;         /**< Signalled when a decision starts or the sampler stops. */
+                pthread_cond_t done;          /**< Signalled when the last thread is done sampling. */
+                long round;                   /**< Number of decisions started. */
+                int running;                  /**< Threads still sampling for the current decision. */
+                int stop;                     /**< 1 once the threads must end. */
+        }Mc_sampler;
+
+        /**
+        * @brief Structure representing the outcome of a simulated game.
+        */
+        typedef struct{
+                int winner;           /**< Winning seat (0 for the player side, 1 for the bot side). */
+                int shots[2];         /**< Number of missiles fired by each seat. */
+        }Sim_result;
          
         //Prototype of every function, it will be more detailled in the corresponding files
         //functions in boat.c
-        Boat createBoat(int indicator);
-        Boat* createBoatList();
+        Boat createBoat(int indicator, Rng* rng);
+        Boat* createBoatList(Rng* rng);
+        void drawBoatList(Boat* boat_list, Rng* rng);
         int check_collision(Boat* boat_list,int nb);
         int collision(Boat* boat1, Boat* boat2);
         void boatPlacement(Game_board* board, Boat* boat_list);
         int isAlive(Boat* boat, Game_board* game);
         int howManyAlive(Boat* boat_list,Game_board* board);
+        int fleetDestroyed(Game_board* board);
+
+        //functions in Config.c
+        void configInit(int* argc, char** argv);
 
         //functions in char.c
         void clearInputBuffer();
@@ -71,23 +374,155 @@
         int getMissile_Y();
 
         //functions in Gameboard.c
+        size_t gameBoardBlockSize(int size);
+        Game_board* gameBoardPlace(void* block, int size);
         Game_board* createGameBoard(int size);
         void gameBoardInit(Game_board* board);
         void gameBoardDisplay(Game_board* board);
         void ennemyBoardDisplay(Game_board* board);
 
+        //functions in Render.c
+        Renderer* rendererCreate(int size, int ansi);
+        void renderBoards(Renderer* renderer, Game_board* boards[2], const int hidden[2], const char* titles[2]);
+        void renderBoard(Game_board* board, int hidden);
+        size_t renderSymbols(char* out, Game_board* board, int hidden);
+        void gameDisplay(Game* game);
+        void rendererFree(Renderer* renderer);
+
         //functions in Game.c
-        Game* createGame();
-        void mainGame();
+        size_t gameBlockSize();
+        Game* gamePlace(void* block);
+        void gameReset(Game* game, uint64_t seed);
+        Game* createGame(uint64_t seed);
+        void mainGame(Bot_type bot_player, Bot_type bot_ennemy);
         void menu();
         void check_const();
         void freeGameBoard(Game_board* board);
         void freeGame(Game* game);
 
+        //functions in GamePool.c
+        Game_pool* gamePoolCreate();
+        Game* gamePoolTake(Game_pool* pool, uint64_t seed);
+        void gamePoolGive(Game_pool* pool, Game* game);
+        void gamePoolFree(Game_pool* pool);
+        Game_pool* gamePoolThread();
+
+        //functions in Stats.c
+        Stats* statsThread();
+        uint64_t statsClock();
+        void statsGame(int shots);
+        void statsCollect(Stats* stats);
+        void statsOpen(const char* path);
+
         //functions in Turn.c
-        int missileShoot(Game_board* board);
-        int bot_Missile_Shoot(Game_board* board);
-        void playerTurn(Game* game);
-        void ennemyTurn(Game* game);
+        Shot_result resolveShot(Game_board* board, int x, int y, int* boat_id);
+        void botTarget(Game_board* board, int* x, int* y, Rng* rng);
+        Shot_result gameShot(Game* game, Game_event* event);
+        Game_step gameStep(Game* game, Game_event* event);
+        int gameInput(Game* game, int x, int y);
+        void shotDisplay(const Game_event* event);
+
+        //functions in Bitboard.c
+        int bitBoardFits(int size);
+        int bitPopcount(Bitmask mask);
+        int bitFirstCell(Bitmask mask);
+        Bitmask bitInsideMask(int size);
+        Bitmask bitGrow(Bitmask mask, int size);
+        void bitBoardInit(Bit_board* board);
+        Bitmask boatMask(Boat* boat);
+        void bitBoatPlacement(Bit_board* board, Boat* boat_list);
+        Shot_result bitMissileShoot(Bit_board* board, int x, int y);
+        int bitCellsAlive(Bit_board* board);
+        int bitHowManyAlive(Boat* boat_list, Bit_board* board);
+
+        //functions in Kernels.c
+        const Board_kernels* boardKernels(int size);
+
+        //functions in Placement.c
+        void placementTableInit();
+        Placement* placementList(int boat_size, int* nb);
+        int samplePlacement(int boat_size, Bitmask occupied, Placement* placement, Rng* rng);
+        int placeFleet(Boat* boat_list, Rng* rng);
+
+        //functions in Rng.c
+        void rngSeed(Rng* rng, uint64_t seed);
+        uint64_t rngNext(Rng* rng);
+        void rngJump(Rng* rng);
+        void rngSplit(Rng* parent, Rng* child);
+        uint64_t rngStreamSeed(uint64_t seed, uint64_t index);
+        int rngBounded(Rng* rng, int bound);
+
+        //functions in Density.c
+        int boardObservation(Game_board* board, Boat* boat_list, Bitmask* free, Bitmask* hits, int* sizes);
+        void densityTarget(Game_board* board, Boat* boat_list, int* x, int* y, Rng* rng);
+
+        //functions in MonteCarlo.c
+        Mc_sampler* monteCarloSamplerCreate(int nb_threads);
+        void monteCarloSamplerFree(Mc_sampler* sampler);
+        void monteCarloTarget(Game_board* board, Boat* boat_list, int* x, int* y, double budget_ms, Mc_sampler* sampler, Rng* rng);
+
+        //functions in Strategy.c
+        Bot_type botTypeFromName(const char* name);
+        const char* botTypeName(Bot_type bot);
+        void seatBind(Game* game, int seat, Bot_type bot);
+        void seatRelease(Game* game);
+        void seatChoose(Game* game, int seat, int* x, int* y);
+        void seatObserve(Game* game, int seat, int x, int y, Shot_result result, int boat_id);
+
+        //functions in Simulation.c
+        void startSimulatedGame(Game* game);
+        int resumeSimulatedGame(Game* game, Bot_type bot_player, Bot_type bot_ennemy, long max_shots);
+        Sim_result playSimulatedGame(Game* game, Bot_type bot_player, Bot_type bot_ennemy);
+        Sim_result simulateGame(Bot_type bot_player, Bot_type bot_ennemy, uint64_t seed);
+        void replayGame(uint64_t seed, long index, Bot_type bot_player, Bot_type bot_ennemy);
+        void runSimulation(long nb_games, Bot_type bot_player, Bot_type bot_ennemy, uint64_t seed);
+
+        //functions in Batch.c
+        void runBatch(long nb_games, Bot_type bot_player, Bot_type bot_ennemy, uint64_t seed);
+
+        //functions in Save.c
+        size_t gameSnapshotSize();
+        void gameSnapshot(Game* game, void* buffer);
+        Game* gameRestore(const void* buffer, size_t size);
+        void saveGames(Game** games, int nb, const char* path);
+        Game** loadGames(const char* path, int* nb);
+        void runCheckpoint(const char* path, int nb_games, long nb_shots, Bot_type bot_player, Bot_type bot_ennemy, uint64_t seed);
+        void runResume(const char* path, Bot_type bot_player, Bot_type bot_ennemy);
+
+        //functions in Book.c
+        Opening_book* bookOpen(const char* path);
+        void bookClose(Opening_book* book);
+        int bookShot(const Opening_book* book, const Game_board* board, int node);
+        int bookFollow(const Opening_book* book, int node, Shot_result result);
+        void runBook(const char* path, int depth);
+
+        //functions in MoveLog.c
+        Move_log* moveLogOpen(const char* path);
+        void moveLogGame(Move_log* log, Game* game, uint64_t seed);
+        void moveLogShot(Game_board* board, int x, int y, Shot_result result, int boat_id);
+        void moveLogFlush(Move_log* log);
+        void moveLogClose(Move_log* log);
+        void runReplay(const char* path, long game_number);
+
+        //functions in Pool.c
+        Thread_pool* poolCreate(int nb_workers);
+        void poolSubmit(Thread_pool* pool, Task_function function, void* arg);
+        void poolRun(Thread_pool* pool);
+        void poolFree(Thread_pool* pool);
+
+        //functions in Tournament.c
+        void wilsonInterval(long wins, long games, double* low, double* high);
+        void runTournament(long nb_games, Bot_type* bots, int nb_bots, int nb_threads, uint64_t seed);
+
+        //functions in Server.c
+        void runServer(int port, Bot_type bot, int nb_threads);
+
+        //functions in Count.c
+        char* countFormat(unsigned __int128 value, char* out);
+        unsigned __int128 countLayouts(Game_board* board, Boat* boat_list, double* probabilities, int progress);
+        void runCount(long nb_shots, Bot_type bot, int with_probabilities);
+
+        //functions in Script.c
+        void runScript(const char* path, int binary, Bot_type bot);
         
 #endif
@@ -1,5 +1,5 @@
 /**
- * @file boat.c
+ * @file main.c
  * @brief main file where the game is started
  * @author Hicham Bettahar
  * @date December 24, 2023
@@ -7,10 +7,86 @@
 #include "header.h"
 
 
-int main(){
+int main(int argc, char** argv){
          
-        srand(time(NULL));
+        configInit(&argc,argv);                                      //--size, --fleet and --seed options
+        if(argc > 1 && strcmp(argv[1],"sim") == 0){                  //headless mode: ./exec sim [nb_games] [bot_player] [bot_ennemy]
+                runSimulation(argc > 2 ? atol(argv[2]) : 100000,
+                              argc > 3 ? botTypeFromName(argv[3]) : BOT_RANDOM,
+                              argc > 4 ? botTypeFromName(argv[4]) : BOT_RANDOM,
+                              game_config.seed);
+                return 0;
+        }
+        if(argc > 1 && strcmp(argv[1],"batch") == 0){                //lockstep batch engine: ./exec batch [nb_games] [bot_player] [bot_ennemy]
+                runBatch(argc > 2 ? atol(argv[2]) : 1000000,
+                         argc > 3 ? botTypeFromName(argv[3]) : BOT_RANDOM,
+                         argc > 4 ? botTypeFromName(argv[4]) : BOT_RANDOM,
+                         game_config.seed);
+                return 0;
+        }
+        if(argc > 1 && strcmp(argv[1],"game") == 0){                 //./exec game <index> [bot_player] [bot_ennemy] --seed <seed>
+                replayGame(game_config.seed,argc > 2 ? atol(argv[2]) : 0,
+                           argc > 3 ? botTypeFromName(argv[3]) : BOT_RANDOM,
+                           argc > 4 ? botTypeFromName(argv[4]) : BOT_RANDOM);
+                return 0;
+        }
+        if(argc > 1 && strcmp(argv[1],"tournament") == 0){           //./exec tournament [nb_games] [bot...]
+                Bot_type bots[argc > 3 ? argc - 3 : 2];
+                int nb_bots = 0;
+                for(int i = 3; i < argc; i++){
+                        bots[nb_bots++] = botTypeFromName(argv[i]);
+                }
+                if(nb_bots == 0){
+                        bots[nb_bots++] = BOT_RANDOM;
+                        bots[nb_bots++] = BOT_DENSITY;
+                }
+                runTournament(argc > 2 ? atol(argv[2]) : 10000,bots,nb_bots,0,game_config.seed);
+                return 0;
+        }
+        if(argc > 2 && strcmp(argv[1],"checkpoint") == 0){           //./exec checkpoint <file> [nb_games] [nb_shots] [bot_player] [bot_ennemy]
+                runCheckpoint(argv[2],argc > 3 ? atoi(argv[3]) : 1000,argc > 4 ? atol(argv[4]) : 40,
+                              argc > 5 ? botTypeFromName(argv[5]) : BOT_RANDOM,
+                              argc > 6 ? botTypeFromName(argv[6]) : BOT_RANDOM,
+                              game_config.seed);
+                return 0;
+        }
+        if(argc > 2 && strcmp(argv[1],"resume") == 0){               //./exec resume <file> [bot_player] [bot_ennemy]
+                runResume(argv[2],argc > 3 ? botTypeFromName(argv[3]) : BOT_RANDOM,
+                          argc > 4 ? botTypeFromName(argv[4]) : BOT_RANDOM);
+                return 0;
+        }
+        if(argc > 2 && strcmp(argv[1],"replay") == 0){               //./exec replay <log> [game]
+                runReplay(argv[2],argc > 3 ? atol(argv[3]) : -1);
+                return 0;
+        }
+        if(argc > 1 && strcmp(argv[1],"server") == 0){               //./exec server [port] [bot] [nb_threads]
+                runServer(argc > 2 ? atoi(argv[2]) : 4242,
+                          argc > 3 ? botTypeFromName(argv[3]) : BOT_DENSITY,
+                          argc > 4 ? atoi(argv[4]) : 0);
+                return 0;
+        }
+        if(argc > 2 && strcmp(argv[1],"book") == 0){                 //./exec book <file> [depth]
+                runBook(argv[2],argc > 3 ? atoi(argv[3]) : BOOK_DEPTH);
+                return 0;
+        }
+        if(argc > 1 && strcmp(argv[1],"count") == 0){                //./exec count [nb_shots] [bot] [number]
+                runCount(argc > 2 ? atol(argv[2]) : 0,
+                         argc > 3 ? botTypeFromName(argv[3]) : BOT_DENSITY,
+                         !(argc > 4 && strcmp(argv[4],"number") == 0));
+                return 0;
+        }
+        if(argc > 1 && strcmp(argv[1],"script") == 0){               //./exec script [file|-] [text|binary] [bot]
+                runScript(argc > 2 ? argv[2] : "-",
+                          argc > 3 && strcmp(argv[3],"binary") == 0,
+                          argc > 4 ? botTypeFromName(argv[4]) : BOT_DENSITY);
+                return 0;
+        }
+        if(argc > 1 && strcmp(argv[1],"play") == 0){                 //./exec play [bot_player] [bot_ennemy]
+                mainGame(argc > 2 ? botTypeFromName(argv[2]) : BOT_HUMAN,
+                         argc > 3 ? botTypeFromName(argv[3]) : BOT_RANDOM);
+                return 0;
+        }
         menu();
 
         return 0;
-}
\ No newline at end of file
+}